@@ -43,6 +43,9 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Included before Opcode headers, which redefine "for"
+#include <thread>
+
 // Precompiled Header
 #include "Stdafx.h"
 
@@ -127,6 +130,139 @@ udword AABBTreeNode::Split(udword axis, AABBTreeBuilder* builder)
 	return NbPos;
 }
 
+//! Number of bins per axis used to evaluate the surface area heuristic
+#define OPC_SAH_NB_BINS	16
+
+//! Surface area of the box given by min and max. Empty boxes (min > max) yield 0.
+static inline_ float SurfaceArea(const Point& min, const Point& max)
+{
+	if(min.x>max.x)	return 0.0f;
+	const Point d = max - min;
+	return 2.0f * (d.x*d.y + d.y*d.z + d.z*d.x);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Splits the node using a binned surface area heuristic.
+ *	Primitive centers are distributed into OPC_SAH_NB_BINS bins along each axis. The split between two bins minimizing
+ *	area(pos) * nb_prims(pos) + area(neg) * nb_prims(neg) is chosen over all three axes.
+ *	The list of indices is reorganized according to the split. Centers and boxes come from the builder's scratch buffers,
+ *	at the node's range of the list of primitives, and are reorganized along with the indices. Nodes being built
+ *	concurrently have disjoint ranges.
+ *	\param		builder		[in] the tree builder
+ *	\return		the number of primitives assigned to the first child, 0 if no valid split has been found
+ *	\warning	this method reorganizes the internal list of primitives
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword AABBTreeNode::SplitSAH(AABBTreeBuilder* builder)
+{
+	struct Bin
+	{
+		Point	mMin;
+		Point	mMax;
+		udword	mNbPrims;
+	};
+
+	// Centers and boxes of node-related primitives, and the box enclosing the centers
+	const size_t Offset = mNodePrimitives - builder->mPrimitiveBase;
+	Point* Centers = builder->mCenters + Offset;
+	AABB* Boxes = builder->mBoxes + Offset;
+	Point CentersMin(MAX_FLOAT, MAX_FLOAT, MAX_FLOAT);
+	Point CentersMax(MIN_FLOAT, MIN_FLOAT, MIN_FLOAT);
+	for(udword i=0;i<mNbPrimitives;i++)
+	{
+		CentersMin.Min(Centers[i]);
+		CentersMax.Max(Centers[i]);
+	}
+
+	float BestCost = MAX_FLOAT;
+	udword BestAxis = INVALID_ID;
+	udword BestBin = 0;
+	for(udword Axis=0;Axis<3;Axis++)
+	{
+		const float Extent = CentersMax[Axis] - CentersMin[Axis];
+		if(Extent<=0.0f)	continue;	// All centers in one plane, can't split along this axis
+		const float Scale = float(OPC_SAH_NB_BINS) / Extent;
+
+		// Distribute primitives into bins
+		Bin Bins[OPC_SAH_NB_BINS];
+		for(udword b=0;b<OPC_SAH_NB_BINS;b++)
+		{
+			Bins[b].mMin.Set(MAX_FLOAT, MAX_FLOAT, MAX_FLOAT);
+			Bins[b].mMax.Set(MIN_FLOAT, MIN_FLOAT, MIN_FLOAT);
+			Bins[b].mNbPrims = 0;
+		}
+		for(udword i=0;i<mNbPrimitives;i++)
+		{
+			udword b = udword((Centers[i][Axis] - CentersMin[Axis]) * Scale);
+			if(b>=OPC_SAH_NB_BINS)	b = OPC_SAH_NB_BINS-1;
+			Point Min, Max;
+			Boxes[i].GetMin(Min);
+			Boxes[i].GetMax(Max);
+			Bins[b].mMin.Min(Min);
+			Bins[b].mMax.Max(Max);
+			Bins[b].mNbPrims++;
+		}
+
+		// Sweep from the high end to get area and number of primitives above each split
+		float HighAreas[OPC_SAH_NB_BINS];
+		udword HighCounts[OPC_SAH_NB_BINS];
+		Point Min(MAX_FLOAT, MAX_FLOAT, MAX_FLOAT);
+		Point Max(MIN_FLOAT, MIN_FLOAT, MIN_FLOAT);
+		udword Count = 0;
+		for(udword b=OPC_SAH_NB_BINS-1;b>0;b--)
+		{
+			Min.Min(Bins[b].mMin);
+			Max.Max(Bins[b].mMax);
+			Count += Bins[b].mNbPrims;
+			HighAreas[b] = SurfaceArea(Min, Max);
+			HighCounts[b] = Count;
+		}
+
+		// Sweep from the low end and evaluate the split after each bin
+		Min.Set(MAX_FLOAT, MAX_FLOAT, MAX_FLOAT);
+		Max.Set(MIN_FLOAT, MIN_FLOAT, MIN_FLOAT);
+		Count = 0;
+		for(udword b=0;b<OPC_SAH_NB_BINS-1;b++)
+		{
+			Min.Min(Bins[b].mMin);
+			Max.Max(Bins[b].mMax);
+			Count += Bins[b].mNbPrims;
+			if(!Count || !HighCounts[b+1])	continue;
+
+			const float Cost = SurfaceArea(Min, Max) * float(Count) + HighAreas[b+1] * float(HighCounts[b+1]);
+			if(Cost<BestCost)
+			{
+				BestCost = Cost;
+				BestAxis = Axis;
+				BestBin = b;
+			}
+		}
+	}
+
+	udword NbPos = 0;
+	if(BestAxis!=INVALID_ID)
+	{
+		// Reorganize the list of indices in this order: positive (above split) - negative (below split)
+		const float Scale = float(OPC_SAH_NB_BINS) / (CentersMax[BestAxis] - CentersMin[BestAxis]);
+		for(udword i=0;i<mNbPrimitives;i++)
+		{
+			udword b = udword((Centers[i][BestAxis] - CentersMin[BestAxis]) * Scale);
+			if(b>=OPC_SAH_NB_BINS)	b = OPC_SAH_NB_BINS-1;
+			if(b>BestBin)
+			{
+				// Swap entries, keeping centers and boxes in sync with indices
+				TSwap(mNodePrimitives[i], mNodePrimitives[NbPos]);
+				TSwap(Centers[i], Centers[NbPos]);
+				TSwap(Boxes[i], Boxes[NbPos]);
+				NbPos++;
+			}
+		}
+	}
+
+	return NbPos;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Subdivides the node.
@@ -143,11 +279,13 @@ udword AABBTreeNode::Split(udword axis, AABBTreeBuilder* builder)
  *	A degenerate tree would have a O(n) depth.
  *	Note a perfectly-balanced tree is not well-suited to collision detection anyway.
  *
- *	\param		builder		[in] the tree builder
+ *	\param		builder				[in] the tree builder
+ *	\param		count				[in/out] number of nodes created so far, determines where children go in a node pool
+ *	\param		nb_invalid_splits	[in/out] number of invalid splits so far
  *	\return		true if success
  */
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder, udword& count, udword& nb_invalid_splits)
 {
 	// Checkings
 	if(!builder)	return false;
@@ -261,6 +399,14 @@ bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder)
 		// Don't even bother splitting (mainly a performance test)
 		NbPos = mNbPrimitives>>1;
 	}
+	else if(builder->mSettings.mRules & SPLIT_SAH)
+	{
+		// Split where the expected cost of ray queries is lowest
+		NbPos = SplitSAH(builder);
+
+		// Check split validity
+		if(!NbPos || NbPos==mNbPrimitives)	ValidSplit = false;
+	}
 	else return false;	// Unknown splitting rules
 
 	// Check the subdivision has been successful
@@ -272,7 +418,7 @@ bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder)
 //		if(builder->mSettings.mRules&SPLIT_COMPLETE)
 		if(builder->mSettings.mLimit==1)
 		{
-			builder->IncreaseNbInvalidSplits();
+			nb_invalid_splits++;
 			NbPos = mNbPrimitives>>1;
 		}
 		else return true;
@@ -283,7 +429,7 @@ bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder)
 	{
 		// We use a pre-allocated linear pool for complete trees [Opcode 1.3]
 		AABBTreeNode* Pool = (AABBTreeNode*)builder->mNodeBase;
-		udword Count = builder->GetCount() - 1;	// Count begins to 1...
+		udword Count = count - 1;	// Count begins to 1...
 		// Set last bit to tell it shouldn't be freed ### pretty ugly, find a better way. Maybe one bit in mNbPrimitives
 		ASSERT(!(udword(&Pool[Count+0])&1));
 		ASSERT(!(udword(&Pool[Count+1])&1));
@@ -306,7 +452,7 @@ bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder)
 	}
 
 	// Update stats
-	builder->IncreaseCount(2);
+	count += 2;
 
 	// Assign children
 	AABBTreeNode* Pos = (AABBTreeNode*)GetPos();
@@ -319,25 +465,53 @@ bool AABBTreeNode::Subdivide(AABBTreeBuilder* builder)
 	return true;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! Subtrees with fewer primitives than this are always built on the current thread
+#define OPC_PARALLEL_BUILD_THRESHOLD	4096
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Recursive hierarchy building in a top-down fashion.
- *	\param		builder		[in] the tree builder
+ *
+ *	Complete trees can be built in parallel: a subtree with N primitives always has 2*N-1 nodes, so the position of the
+ *	negative subtree's nodes in the pool is known before the positive subtree is built. Both subtrees are then built
+ *	concurrently and the resulting pool is identical to the one from a single-threaded build.
+ *
+ *	\param		builder				[in] the tree builder
+ *	\param		count				[in/out] number of nodes created so far
+ *	\param		nb_invalid_splits	[in/out] number of invalid splits so far
+ *	\param		nb_threads			[in] number of threads available for this subtree
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void AABBTreeNode::_BuildHierarchy(AABBTreeBuilder* builder)
+void AABBTreeNode::_BuildHierarchy(AABBTreeBuilder* builder, udword& count, udword& nb_invalid_splits, udword nb_threads)
 {
 	// 1) Compute the global box for current node. The box is stored in mBV.
 	builder->ComputeGlobalBox(mNodePrimitives, mNbPrimitives, mBV);
 
 	// 2) Subdivide current node
-	Subdivide(builder);
+	Subdivide(builder, count, nb_invalid_splits);
 
 	// 3) Recurse
 	AABBTreeNode* Pos = (AABBTreeNode*)GetPos();
 	AABBTreeNode* Neg = (AABBTreeNode*)GetNeg();
-	if(Pos)	Pos->_BuildHierarchy(builder);
-	if(Neg)	Neg->_BuildHierarchy(builder);
+	if(Pos && Neg && nb_threads>1 && builder->mNodeBase && mNbPrimitives>=OPC_PARALLEL_BUILD_THRESHOLD)
+	{
+		// Fork positive subtree. It creates 2*N-2 nodes below its root.
+		udword PosCount = count;
+		udword PosNbInvalidSplits = 0;
+		const udword PosNbThreads = nb_threads / 2;
+		std::thread PosThread([&]() { Pos->_BuildHierarchy(builder, PosCount, PosNbInvalidSplits, PosNbThreads); });
+
+		count += 2 * Pos->mNbPrimitives - 2;
+		Neg->_BuildHierarchy(builder, count, nb_invalid_splits, nb_threads - PosNbThreads);
+
+		PosThread.join();
+		nb_invalid_splits += PosNbInvalidSplits;
+	}
+	else
+	{
+		if(Pos)	Pos->_BuildHierarchy(builder, count, nb_invalid_splits, nb_threads);
+		if(Neg)	Neg->_BuildHierarchy(builder, count, nb_invalid_splits, nb_threads);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -429,8 +603,37 @@ bool AABBTree::Build(AABBTreeBuilder* builder)
 		builder->mNodeBase = mPool;	// ### ugly !
 	}
 
+	// Gather centers and boxes once for the SAH split. Nodes then work on their part of these buffers.
+	Point* Centers = null;
+	AABB* Boxes = null;
+	if(builder->mSettings.mRules & SPLIT_SAH)
+	{
+		Centers = new Point[builder->mNbPrimitives];
+		CHECKALLOC(Centers);
+		Boxes = new AABB[builder->mNbPrimitives];
+		CHECKALLOC(Boxes);
+		for(udword i=0;i<builder->mNbPrimitives;i++)
+		{
+			Centers[i] = builder->GetSplittingValues(mIndices[i]);
+			builder->ComputeGlobalBox(&mIndices[i], 1, Boxes[i]);
+		}
+	}
+	builder->mPrimitiveBase	= mIndices;
+	builder->mCenters		= Centers;
+	builder->mBoxes			= Boxes;
+
 	// Build the hierarchy
-	_BuildHierarchy(builder);
+	udword Count = builder->GetCount();
+	udword NbInvalidSplits = builder->GetNbInvalidSplits();
+	_BuildHierarchy(builder, Count, NbInvalidSplits, builder->mSettings.mNbThreads);
+	builder->SetCount(Count);
+	builder->SetNbInvalidSplits(NbInvalidSplits);
+
+	builder->mPrimitiveBase	= null;
+	builder->mCenters		= null;
+	builder->mBoxes			= null;
+	DELETEARRAY(Boxes);
+	DELETEARRAY(Centers);
 
 	// Get back total number of nodes
 	mTotalNbNodes	= builder->GetCount();
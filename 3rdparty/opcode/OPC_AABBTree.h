@@ -88,8 +88,9 @@
 				udword				mNbPrimitives;		//!< Number of primitives for this node
 		// Internal methods
 				udword				Split(udword axis, AABBTreeBuilder* builder);
-				bool				Subdivide(AABBTreeBuilder* builder);
-				void				_BuildHierarchy(AABBTreeBuilder* builder);
+				udword				SplitSAH(AABBTreeBuilder* builder);
+				bool				Subdivide(AABBTreeBuilder* builder, udword& count, udword& nb_invalid_splits);
+				void				_BuildHierarchy(AABBTreeBuilder* builder, udword& count, udword& nb_invalid_splits, udword nb_threads);
 				void				_Refit(AABBTreeBuilder* builder);
 	};
 
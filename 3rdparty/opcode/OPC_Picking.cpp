@@ -21,6 +21,20 @@
 
 using namespace Opcode;
 
+bool Opcode::SetupShadowFeeler(RayCollider& collider, float min_dist)
+{
+	collider.SetFirstContact(true);
+	collider.SetTemporalCoherence(false);
+#ifdef OPC_RAYHIT_CALLBACK
+	collider.SetHitCallback(null);
+#else
+	collider.SetClosestHit(false);
+	collider.SetDestination(null);
+#endif
+	collider.SetMinDist(min_dist);
+	return true;
+}
+
 #ifdef OPC_RAYHIT_CALLBACK
 
 /*
@@ -67,13 +81,6 @@ bool Opcode::SetupClosestHit(RayCollider& collider, CollisionFace& closest_conta
 	return true;
 }
 
-bool Opcode::SetupShadowFeeler(RayCollider& collider)
-{
-	collider.SetFirstContact(true);
-	collider.SetHitCallback(null);
-	return true;
-}
-
 bool Opcode::SetupInOutTest(RayCollider& collider)
 {
 	collider.SetFirstContact(false);
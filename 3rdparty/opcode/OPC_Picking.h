@@ -20,6 +20,17 @@
 #ifndef __OPC_PICKING_H__
 #define __OPC_PICKING_H__
 
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/**
+	 *	Setups a collider for boolean "any hit" queries. The query stops at the first face hit beyond min_dist,
+	 *	results are retrieved with collider.GetContactStatus().
+	 *	\param		collider	[in] ray collider to setup
+	 *	\param		min_dist	[in] hits up to this distance are ignored, e.g. to skip the surface the ray starts on
+	 *	\return		true if success
+	 */
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	OPCODE_API	bool SetupShadowFeeler	(RayCollider& collider, float min_dist=MIN_FLOAT);
+
 #ifdef OPC_RAYHIT_CALLBACK
 
 	enum CullMode
@@ -33,7 +44,6 @@
 
 	OPCODE_API	bool SetupAllHits		(RayCollider& collider, CollisionFaces& contacts);
 	OPCODE_API	bool SetupClosestHit	(RayCollider& collider, CollisionFace& closest_contact);
-	OPCODE_API	bool SetupShadowFeeler	(RayCollider& collider);
 	OPCODE_API	bool SetupInOutTest		(RayCollider& collider);
 
 	OPCODE_API	bool Picking(
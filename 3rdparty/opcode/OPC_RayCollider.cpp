@@ -73,6 +73,12 @@
  *		- It currently only works in "all contacts" mode.
  *		- If closest hit is enabled, faces are sorted by distance on-the-fly and the closest one only is reported.
  *
+ *	LOWER DISTANCE BOUND:
+ *
+ *		- You can ignore hits close to the ray origin with RayCollider::SetMinDist().
+ *		- Rejected hits don't count as contacts, so in "first contact" mode the query goes on until a hit beyond the bound
+ *		is found. Use this for shadow feelers starting on a surface, which would otherwise hit the surface itself.
+ *
  *	BACKFACE CULLING:
  *
  *		- You can enable or disable backface culling with RayCollider::SetCulling().
@@ -118,6 +124,7 @@ using namespace Opcode;
 
 #include "OPC_RayAABBOverlap.h"
 #include "OPC_RayTriOverlap.h"
+#include "OPC_RayPacketOverlap.h"
 
 #define SET_CONTACT(prim_index, flag)											\
 	mNbIntersections++;															\
@@ -178,9 +185,9 @@ using namespace Opcode;
 	/* Perform ray-tri overlap test and return */											\
 	if(RayTriOverlap(*VP.Vertex[0], *VP.Vertex[1], *VP.Vertex[2]))							\
 	{																						\
-		/* Intersection point is valid if dist < segment's length */						\
+		/* Intersection point is valid if min dist < dist < segment's length */			\
 		/* We know dist>0 so we can use integers */											\
-		if(IR(mStabbedFace.mDistance)<IR(mMaxDist))											\
+		if(IR(mStabbedFace.mDistance)<IR(mMaxDist) && mStabbedFace.mDistance>mMinDist)		\
 		{																					\
 			HANDLE_CONTACT(prim_index, flag)												\
 		}																					\
@@ -193,7 +200,20 @@ using namespace Opcode;
 	/* Perform ray-tri overlap test and return */											\
 	if(RayTriOverlap(*VP.Vertex[0], *VP.Vertex[1], *VP.Vertex[2]))							\
 	{																						\
-		HANDLE_CONTACT(prim_index, flag)													\
+		/* Intersection point is valid if dist > min dist */								\
+		if(mStabbedFace.mDistance>mMinDist)													\
+		{																					\
+			HANDLE_CONTACT(prim_index, flag)												\
+		}																					\
+	}
+
+#define PACKET_PRIM(prim_index, active)														\
+	{																						\
+		/* Request vertices from the app */													\
+		VertexPointers VP;	ConversionArea VC;	mIMesh->GetTriangle(VP, prim_index, VC);	\
+																							\
+		/* Perform packet-tri overlap test, hits are already within the distance bounds */	\
+		mPacketHits |= PacketTriOverlap(*VP.Vertex[0], *VP.Vertex[1], *VP.Vertex[2], active);\
 	}
 
 
@@ -213,7 +233,9 @@ RayCollider::RayCollider() :
 	mNbRayBVTests		(0),
 	mNbRayPrimTests		(0),
 	mNbIntersections	(0),
+	mMinDist			(MIN_FLOAT),
 	mMaxDist			(MAX_FLOAT),
+	mPacketHits			(0),
 	mCulling			(true)
 
 {
@@ -237,6 +259,7 @@ RayCollider::~RayCollider()
 const char* RayCollider::ValidateSettings()
 {
 	if(mMaxDist<0.0f)											return "Higher distance bound must be positive!";
+	if(mMinDist>=mMaxDist)										return "Lower distance bound must be smaller than higher distance bound!";
 	if(TemporalCoherenceEnabled() && !FirstContactEnabled())	return "Temporal coherence only works with ""First contact"" mode!";
 #ifndef OPC_RAYHIT_CALLBACK
 	if(mClosestHit && FirstContactEnabled())					return "Closest hit doesn't work with ""First contact"" mode!";
@@ -485,6 +508,128 @@ bool RayCollider::Collide(const Ray& world_ray, const AABBTree* tree, Container&
 	return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Packet stabbing query for generic OPCODE models. The tree is traversed once for all rays of the packet, and each ray
+ *	stops at its first hit.
+ *
+ *	\param		packet			[in] stabbing rays in model space
+ *	\param		model			[in] Opcode model to collide with
+ *	\param		hit_mask		[out] one bit per ray, set if the ray hit the model
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool RayCollider::CollidePacket(const RayPacket& packet, const Model& model, udword& hit_mask)
+{
+	hit_mask = 0;
+
+	// Checkings
+	if(!Setup(&model))	return false;
+
+	// Init collision query
+	if(!InitPacketQuery(packet))
+	{
+		const udword Active = (1<<packet.GetNbRays())-1;
+
+		if(!model.HasLeafNodes())
+		{
+			if(model.IsQuantized())
+			{
+				const AABBQuantizedNoLeafTree* Tree = (const AABBQuantizedNoLeafTree*)model.GetTree();
+
+				// Setup dequantization coeffs
+				mCenterCoeff	= Tree->mCenterCoeff;
+				mExtentsCoeff	= Tree->mExtentsCoeff;
+
+				_PacketStab(Tree->GetNodes(), Active);
+			}
+			else
+			{
+				const AABBNoLeafTree* Tree = (const AABBNoLeafTree*)model.GetTree();
+				_PacketStab(Tree->GetNodes(), Active);
+			}
+		}
+		else
+		{
+			if(model.IsQuantized())
+			{
+				const AABBQuantizedTree* Tree = (const AABBQuantizedTree*)model.GetTree();
+
+				// Setup dequantization coeffs
+				mCenterCoeff	= Tree->mCenterCoeff;
+				mExtentsCoeff	= Tree->mExtentsCoeff;
+
+				_PacketStab(Tree->GetNodes(), Active);
+			}
+			else
+			{
+				const AABBCollisionTree* Tree = (const AABBCollisionTree*)model.GetTree();
+				_PacketStab(Tree->GetNodes(), Active);
+			}
+		}
+	}
+
+	// Set contact status
+	for(udword i=0;i<OPC_PACKET_SIZE;i++)	if(mPacketHits&(1<<i))	mNbIntersections++;
+	if(mPacketHits)	mFlags |= OPC_CONTACT;
+
+	hit_mask = mPacketHits;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Initializes a packet stabbing query :
+ *	- reset stats & contact status
+ *	- store rays in structure-of-arrays form, with precomputed data for ray-AABB or segment-AABB tests
+ *
+ *	\param		packet		[in] stabbing rays in model space
+ *	\return		TRUE if we can return immediately
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOL RayCollider::InitPacketQuery(const RayPacket& packet)
+{
+	// Reset stats & contact status
+	Collider::InitQuery();
+	mNbRayBVTests		= 0;
+	mNbRayPrimTests		= 0;
+	mNbIntersections	= 0;
+	mPacketHits			= 0;
+
+	// Copy rays, unused lanes get harmless values and are never reported
+	const udword NbRays = packet.GetNbRays();
+	for(udword j=0;j<3;j++)
+	{
+		for(udword i=0;i<OPC_PACKET_SIZE;i++)
+		{
+			mPacketOrigin[j][i]	= i<NbRays ? packet.mOrig[j][i] : 0.0f;
+			mPacketDir[j][i]	= i<NbRays ? packet.mDir[j][i] : 0.0f;
+
+			// Precompute data, same as in InitQuery()
+			if(IR(mMaxDist)!=IEEE_MAX_FLOAT)
+			{
+				mPacketData[j][i]	= 0.5f * mPacketDir[j][i] * mMaxDist;
+				mPacketData2[j][i]	= mPacketOrigin[j][i] + mPacketData[j][i];
+				mPacketFDir[j][i]	= fabsf(mPacketData[j][i]);
+			}
+			else
+			{
+				mPacketFDir[j][i]	= fabsf(mPacketDir[j][i]);
+			}
+		}
+	}
+
+	if(!NbRays)	return TRUE;
+
+	// Special case: 1-triangle meshes
+	if(mCurrentModel && mCurrentModel->HasSingleNode())
+	{
+		PACKET_PRIM(udword(0), (1<<NbRays)-1)
+		return TRUE;
+	}
+	return FALSE;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
@@ -762,3 +907,127 @@ void RayCollider::_RayStab(const AABBTreeNode* node, Container& box_indices)
 		_RayStab(node->GetNeg(), box_indices);
 	}
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Recursive packet stabbing query for normal AABB trees.
+ *	\param		node	[in] current collision node
+ *	\param		active	[in] rays of the packet overlapping the parent node, one bit per ray
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RayCollider::_PacketStab(const AABBCollisionNode* node, udword active)
+{
+	// Perform Packet-AABB overlap test, for rays without a hit so far
+	active = PacketAABBOverlap(node->mAABB.mCenter, node->mAABB.mExtents, active & ~mPacketHits);
+	if(!active)	return;
+
+	if(node->IsLeaf())
+	{
+		PACKET_PRIM(node->GetPrimitive(), active)
+	}
+	else
+	{
+		_PacketStab(node->GetPos(), active);
+
+		active &= ~mPacketHits;
+		if(!active)	return;
+
+		_PacketStab(node->GetNeg(), active);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Recursive packet stabbing query for no-leaf AABB trees.
+ *	\param		node	[in] current collision node
+ *	\param		active	[in] rays of the packet overlapping the parent node, one bit per ray
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RayCollider::_PacketStab(const AABBNoLeafNode* node, udword active)
+{
+	// Perform Packet-AABB overlap test, for rays without a hit so far
+	active = PacketAABBOverlap(node->mAABB.mCenter, node->mAABB.mExtents, active & ~mPacketHits);
+	if(!active)	return;
+
+	if(node->HasPosLeaf())
+	{
+		PACKET_PRIM(node->GetPosPrimitive(), active)
+	}
+	else _PacketStab(node->GetPos(), active);
+
+	active &= ~mPacketHits;
+	if(!active)	return;
+
+	if(node->HasNegLeaf())
+	{
+		PACKET_PRIM(node->GetNegPrimitive(), active)
+	}
+	else _PacketStab(node->GetNeg(), active);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Recursive packet stabbing query for quantized AABB trees.
+ *	\param		node	[in] current collision node
+ *	\param		active	[in] rays of the packet overlapping the parent node, one bit per ray
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RayCollider::_PacketStab(const AABBQuantizedNode* node, udword active)
+{
+	// Dequantize box
+	const QuantizedAABB& Box = node->mAABB;
+	const Point Center(float(Box.mCenter[0]) * mCenterCoeff.x, float(Box.mCenter[1]) * mCenterCoeff.y, float(Box.mCenter[2]) * mCenterCoeff.z);
+	const Point Extents(float(Box.mExtents[0]) * mExtentsCoeff.x, float(Box.mExtents[1]) * mExtentsCoeff.y, float(Box.mExtents[2]) * mExtentsCoeff.z);
+
+	// Perform Packet-AABB overlap test, for rays without a hit so far
+	active = PacketAABBOverlap(Center, Extents, active & ~mPacketHits);
+	if(!active)	return;
+
+	if(node->IsLeaf())
+	{
+		PACKET_PRIM(node->GetPrimitive(), active)
+	}
+	else
+	{
+		_PacketStab(node->GetPos(), active);
+
+		active &= ~mPacketHits;
+		if(!active)	return;
+
+		_PacketStab(node->GetNeg(), active);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Recursive packet stabbing query for quantized no-leaf AABB trees.
+ *	\param		node	[in] current collision node
+ *	\param		active	[in] rays of the packet overlapping the parent node, one bit per ray
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RayCollider::_PacketStab(const AABBQuantizedNoLeafNode* node, udword active)
+{
+	// Dequantize box
+	const QuantizedAABB& Box = node->mAABB;
+	const Point Center(float(Box.mCenter[0]) * mCenterCoeff.x, float(Box.mCenter[1]) * mCenterCoeff.y, float(Box.mCenter[2]) * mCenterCoeff.z);
+	const Point Extents(float(Box.mExtents[0]) * mExtentsCoeff.x, float(Box.mExtents[1]) * mExtentsCoeff.y, float(Box.mExtents[2]) * mExtentsCoeff.z);
+
+	// Perform Packet-AABB overlap test, for rays without a hit so far
+	active = PacketAABBOverlap(Center, Extents, active & ~mPacketHits);
+	if(!active)	return;
+
+	if(node->HasPosLeaf())
+	{
+		PACKET_PRIM(node->GetPosPrimitive(), active)
+	}
+	else _PacketStab(node->GetPos(), active);
+
+	active &= ~mPacketHits;
+	if(!active)	return;
+
+	if(node->HasNegLeaf())
+	{
+		PACKET_PRIM(node->GetNegPrimitive(), active)
+	}
+	else _PacketStab(node->GetNeg(), active);
+}
@@ -49,6 +49,40 @@
 		inline_	void					AddFace(const CollisionFace& face)		{ Add(face.mFaceID).Add(face.mDistance).Add(face.mU).Add(face.mV);	}
 	};
 
+	class OPCODE_API RayPacket
+	{
+		public:
+		//! Constructor
+		inline_				RayPacket() : mNbRays(0)	{ ZeroMemory(mOrig, sizeof(mOrig)); ZeroMemory(mDir, sizeof(mDir));	}
+		//! Destructor
+		inline_				~RayPacket()				{}
+
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		/**
+		 *	Appends a ray to the packet.
+		 *	\param		orig		[in] ray origin
+		 *	\param		dir			[in] ray direction (normalized)
+		 *	\return		true if success, false if the packet is full
+		 */
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		inline_	bool		AddRay(const Point& orig, const Point& dir)
+							{
+								if(mNbRays==OPC_PACKET_SIZE)	return false;
+								mOrig[0][mNbRays] = orig.x;	mOrig[1][mNbRays] = orig.y;	mOrig[2][mNbRays] = orig.z;
+								mDir[0][mNbRays] = dir.x;	mDir[1][mNbRays] = dir.y;	mDir[2][mNbRays] = dir.z;
+								mNbRays++;
+								return true;
+							}
+
+		inline_	void		Reset()						{ mNbRays = 0;								}
+		inline_	udword		GetNbRays()			const	{ return mNbRays;							}
+		inline_	BOOL		IsFull()			const	{ return mNbRays==OPC_PACKET_SIZE;			}
+
+				float		mOrig[3][OPC_PACKET_SIZE];	//!< Ray origins, one array per axis
+				float		mDir[3][OPC_PACKET_SIZE];	//!< Ray directions (normalized), one array per axis
+				udword		mNbRays;					//!< Number of valid rays
+	};
+
 #ifdef OPC_RAYHIT_CALLBACK
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/**
@@ -84,6 +118,25 @@
 							bool			Collide(const Ray& world_ray, const Model& model, const Matrix4x4* world=null, udword* cache=null);
 		//
 							bool			Collide(const Ray& world_ray, const AABBTree* tree, Container& box_indices);
+
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		/**
+		 *	Packet stabbing query for generic OPCODE models. The tree is traversed once for all rays of the packet, and each ray
+		 *	stops at its first hit, as in "first contact" mode. This is meant for coherent shadow feelers, e.g. many rays
+		 *	starting at the same point. After the call, access the results:
+		 *	- in hit_mask, bit i is set if ray i hit the model
+		 *	- with GetContactStatus(), true if any ray hit the model
+		 *
+		 *	Distance bounds and culling settings are honored, and a ray of the packet gets the same answer as the single-ray
+		 *	query in "first contact" mode. Temporal coherence, closest hit and the destination array are not used.
+		 *
+		 *	\param		packet			[in] stabbing rays in model space
+		 *	\param		model			[in] Opcode model to collide with
+		 *	\param		hit_mask		[out] one bit per ray, set if the ray hit the model
+		 *	\return		true if success
+		 */
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+							bool			CollidePacket(const RayPacket& packet, const Model& model, udword& hit_mask);
 		// Settings
 
 #ifndef OPC_RAYHIT_CALLBACK
@@ -120,6 +173,16 @@
 		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		inline_				void			SetMaxDist(float max_dist=MAX_FLOAT)	{ mMaxDist		= max_dist;	}
 
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		/**
+		 *	Settings: sets the lower distance bound. Hits at a distance smaller than or equal to this bound are ignored. Combined
+		 *	with "first contact" mode, this gives shadow feelers that skip self-intersections near the ray origin.
+		 *	\param		min_dist	[in] lower distance bound. Default = minimal value, i.e. all hits are reported
+		 *	\see		SetMaxDist(float max_dist)
+		 */
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		inline_				void			SetMinDist(float min_dist=MIN_FLOAT)	{ mMinDist		= min_dist;	}
+
 #ifdef OPC_RAYHIT_CALLBACK
 		inline_				void			SetHitCallback(HitCallback cb)			{ mHitCallback	= cb;			}
 		inline_				void			SetUserData(void* user_data)			{ mUserData		= user_data;	}
@@ -199,7 +262,15 @@
 							Point			mCenterCoeff;
 							Point			mExtentsCoeff;
 		// Settings
+							float			mMinDist;			//!< Hits up to this distance are ignored
 							float			mMaxDist;			//!< Valid segment on the ray
+		// Packet in local space
+							float			mPacketOrigin[3][OPC_PACKET_SIZE];	//!< Ray origins
+							float			mPacketDir[3][OPC_PACKET_SIZE];		//!< Ray directions
+							float			mPacketFDir[3][OPC_PACKET_SIZE];	//!< fabsf(mPacketDir), or fabsf(mPacketData) for segments
+							float			mPacketData[3][OPC_PACKET_SIZE];	//!< Segment half-vectors
+							float			mPacketData2[3][OPC_PACKET_SIZE];	//!< Segment centers
+							udword			mPacketHits;		//!< One bit per ray that hit something
 
 							bool			mCulling;			//!< Stab culled faces or not
 		// Internal methods
@@ -213,12 +284,19 @@
 							void			_RayStab(const AABBQuantizedNode* node);
 							void			_RayStab(const AABBQuantizedNoLeafNode* node);
 							void			_RayStab(const AABBTreeNode* node, Container& box_indices);
+							void			_PacketStab(const AABBCollisionNode* node, udword active);
+							void			_PacketStab(const AABBNoLeafNode* node, udword active);
+							void			_PacketStab(const AABBQuantizedNode* node, udword active);
+							void			_PacketStab(const AABBQuantizedNoLeafNode* node, udword active);
 			// Overlap tests
 		inline_				BOOL			RayAABBOverlap(const Point& center, const Point& extents);
 		inline_				BOOL			SegmentAABBOverlap(const Point& center, const Point& extents);
 		inline_				BOOL			RayTriOverlap(const Point& vert0, const Point& vert1, const Point& vert2);
+		inline_				udword			PacketAABBOverlap(const Point& center, const Point& extents, udword active);
+		inline_				udword			PacketTriOverlap(const Point& vert0, const Point& vert1, const Point& vert2, udword active);
 			// Init methods
 							BOOL			InitQuery(const Ray& world_ray, const Matrix4x4* world=null, udword* face_id=null);
+							BOOL			InitPacketQuery(const RayPacket& packet);
 	};
 
 #endif // __OPC_RAYCOLLIDER_H__
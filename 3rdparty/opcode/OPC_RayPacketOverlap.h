@@ -0,0 +1,361 @@
+// Packet versions of the ray-AABB and ray-triangle tests.
+//
+// Each ray of the packet goes through exactly the same operations as in OPC_RayAABBOverlap.h and OPC_RayTriOverlap.h,
+// so a packet query reports the same hits as single-ray queries. With OPC_USE_AVX the 8 rays of a packet are processed
+// at once, with OPC_USE_SSE 4 at a time, else one lane after the other.
+
+#ifdef OPC_USE_AVX
+	#if OPC_PACKET_SIZE!=8
+		#error "The AVX packet tests process exactly 8 rays"
+	#endif
+	//! Clears the sign bits
+	inline_ __m256 PacketAbs(__m256 x)				{ return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));	}
+	//! Returns a full lane mask where the sign bit is set, i.e. IS_NEGATIVE_FLOAT() on each lane
+	inline_ __m256 PacketIsNegative(__m256 x)		{ return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(x), 31));	}
+	//! Returns a full lane mask where IR(a)>IR(b)
+	inline_ __m256 PacketIntGreater(__m256 a, __m256 b)
+	{
+		const __m256i Bias = _mm256_set1_epi32(0x80000000);
+		return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_xor_si256(_mm256_castps_si256(a), Bias), _mm256_xor_si256(_mm256_castps_si256(b), Bias)));
+	}
+#elif defined(OPC_USE_SSE)
+	//! Clears the sign bits
+	inline_ __m128 PacketAbs(__m128 x)				{ return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));		}
+	//! Returns a full lane mask where the sign bit is set, i.e. IS_NEGATIVE_FLOAT() on each lane
+	inline_ __m128 PacketIsNegative(__m128 x)		{ return _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(x), 31));			}
+	//! Returns a full lane mask where IR(a)>IR(b)
+	inline_ __m128 PacketIntGreater(__m128 a, __m128 b)
+	{
+		const __m128i Bias = _mm_set1_epi32(0x80000000);
+		return _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_xor_si128(_mm_castps_si128(a), Bias), _mm_xor_si128(_mm_castps_si128(b), Bias)));
+	}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Computes ray-AABB or segment-AABB overlap tests for a packet of rays, using the separating axis theorem. Rays are
+ *	cached within the class.
+ *	\param		center	[in] AABB center
+ *	\param		extents	[in] AABB extents
+ *	\param		active	[in] rays to test, one bit per ray
+ *	\return		rays overlapping the box, one bit per ray
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline_ udword RayCollider::PacketAABBOverlap(const Point& center, const Point& extents, udword active)
+{
+	// Stats
+	mNbRayBVTests++;
+
+	const BOOL Segment = IR(mMaxDist)!=IEEE_MAX_FLOAT;
+	udword Overlap = 0;
+#ifdef OPC_USE_AVX
+	const __m256 Cx = _mm256_set1_ps(center.x);	const __m256 Ex = _mm256_set1_ps(extents.x);
+	const __m256 Cy = _mm256_set1_ps(center.y);	const __m256 Ey = _mm256_set1_ps(extents.y);
+	const __m256 Cz = _mm256_set1_ps(center.z);	const __m256 Ez = _mm256_set1_ps(extents.z);
+
+	const __m256 FDx = _mm256_loadu_ps(mPacketFDir[0]);
+	const __m256 FDy = _mm256_loadu_ps(mPacketFDir[1]);
+	const __m256 FDz = _mm256_loadu_ps(mPacketFDir[2]);
+
+	__m256 Dx, Dy, Dz, Rx, Ry, Rz, Reject;
+	if(Segment)
+	{
+		Dx = _mm256_sub_ps(_mm256_loadu_ps(mPacketData2[0]), Cx);
+		Dy = _mm256_sub_ps(_mm256_loadu_ps(mPacketData2[1]), Cy);
+		Dz = _mm256_sub_ps(_mm256_loadu_ps(mPacketData2[2]), Cz);
+		Reject =					_mm256_cmp_ps(PacketAbs(Dx), _mm256_add_ps(Ex, FDx), _CMP_GT_OQ);
+		Reject = _mm256_or_ps(Reject, _mm256_cmp_ps(PacketAbs(Dy), _mm256_add_ps(Ey, FDy), _CMP_GT_OQ));
+		Reject = _mm256_or_ps(Reject, _mm256_cmp_ps(PacketAbs(Dz), _mm256_add_ps(Ez, FDz), _CMP_GT_OQ));
+		Rx = _mm256_loadu_ps(mPacketData[0]);
+		Ry = _mm256_loadu_ps(mPacketData[1]);
+		Rz = _mm256_loadu_ps(mPacketData[2]);
+	}
+	else
+	{
+		const __m256 Zero = _mm256_setzero_ps();
+		Rx = _mm256_loadu_ps(mPacketDir[0]);
+		Ry = _mm256_loadu_ps(mPacketDir[1]);
+		Rz = _mm256_loadu_ps(mPacketDir[2]);
+		Dx = _mm256_sub_ps(_mm256_loadu_ps(mPacketOrigin[0]), Cx);
+		Dy = _mm256_sub_ps(_mm256_loadu_ps(mPacketOrigin[1]), Cy);
+		Dz = _mm256_sub_ps(_mm256_loadu_ps(mPacketOrigin[2]), Cz);
+		Reject =					_mm256_and_ps(_mm256_cmp_ps(PacketAbs(Dx), Ex, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_mul_ps(Dx, Rx), Zero, _CMP_GE_OQ));
+		Reject = _mm256_or_ps(Reject, _mm256_and_ps(_mm256_cmp_ps(PacketAbs(Dy), Ey, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_mul_ps(Dy, Ry), Zero, _CMP_GE_OQ)));
+		Reject = _mm256_or_ps(Reject, _mm256_and_ps(_mm256_cmp_ps(PacketAbs(Dz), Ez, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_mul_ps(Dz, Rz), Zero, _CMP_GE_OQ)));
+	}
+
+	__m256 f;
+	f = _mm256_sub_ps(_mm256_mul_ps(Ry, Dz), _mm256_mul_ps(Rz, Dy));
+	Reject = _mm256_or_ps(Reject, _mm256_cmp_ps(PacketAbs(f), _mm256_add_ps(_mm256_mul_ps(Ey, FDz), _mm256_mul_ps(Ez, FDy)), _CMP_GT_OQ));
+	f = _mm256_sub_ps(_mm256_mul_ps(Rz, Dx), _mm256_mul_ps(Rx, Dz));
+	Reject = _mm256_or_ps(Reject, _mm256_cmp_ps(PacketAbs(f), _mm256_add_ps(_mm256_mul_ps(Ex, FDz), _mm256_mul_ps(Ez, FDx)), _CMP_GT_OQ));
+	f = _mm256_sub_ps(_mm256_mul_ps(Rx, Dy), _mm256_mul_ps(Ry, Dx));
+	Reject = _mm256_or_ps(Reject, _mm256_cmp_ps(PacketAbs(f), _mm256_add_ps(_mm256_mul_ps(Ex, FDy), _mm256_mul_ps(Ey, FDx)), _CMP_GT_OQ));
+
+	Overlap = udword(_mm256_movemask_ps(Reject))^0xff;
+#elif defined(OPC_USE_SSE)
+	const __m128 Cx = _mm_set1_ps(center.x);	const __m128 Ex = _mm_set1_ps(extents.x);
+	const __m128 Cy = _mm_set1_ps(center.y);	const __m128 Ey = _mm_set1_ps(extents.y);
+	const __m128 Cz = _mm_set1_ps(center.z);	const __m128 Ez = _mm_set1_ps(extents.z);
+
+	for(udword i=0;i<OPC_PACKET_SIZE;i+=4)
+	{
+		if(!((active>>i)&15))	continue;
+
+		const __m128 FDx = _mm_loadu_ps(&mPacketFDir[0][i]);
+		const __m128 FDy = _mm_loadu_ps(&mPacketFDir[1][i]);
+		const __m128 FDz = _mm_loadu_ps(&mPacketFDir[2][i]);
+
+		__m128 Dx, Dy, Dz, Rx, Ry, Rz, Reject;
+		if(Segment)
+		{
+			Dx = _mm_sub_ps(_mm_loadu_ps(&mPacketData2[0][i]), Cx);
+			Dy = _mm_sub_ps(_mm_loadu_ps(&mPacketData2[1][i]), Cy);
+			Dz = _mm_sub_ps(_mm_loadu_ps(&mPacketData2[2][i]), Cz);
+			Reject =				_mm_cmpgt_ps(PacketAbs(Dx), _mm_add_ps(Ex, FDx));
+			Reject = _mm_or_ps(Reject, _mm_cmpgt_ps(PacketAbs(Dy), _mm_add_ps(Ey, FDy)));
+			Reject = _mm_or_ps(Reject, _mm_cmpgt_ps(PacketAbs(Dz), _mm_add_ps(Ez, FDz)));
+			Rx = _mm_loadu_ps(&mPacketData[0][i]);
+			Ry = _mm_loadu_ps(&mPacketData[1][i]);
+			Rz = _mm_loadu_ps(&mPacketData[2][i]);
+		}
+		else
+		{
+			const __m128 Zero = _mm_setzero_ps();
+			Rx = _mm_loadu_ps(&mPacketDir[0][i]);
+			Ry = _mm_loadu_ps(&mPacketDir[1][i]);
+			Rz = _mm_loadu_ps(&mPacketDir[2][i]);
+			Dx = _mm_sub_ps(_mm_loadu_ps(&mPacketOrigin[0][i]), Cx);
+			Dy = _mm_sub_ps(_mm_loadu_ps(&mPacketOrigin[1][i]), Cy);
+			Dz = _mm_sub_ps(_mm_loadu_ps(&mPacketOrigin[2][i]), Cz);
+			Reject =				_mm_and_ps(_mm_cmpgt_ps(PacketAbs(Dx), Ex), _mm_cmpge_ps(_mm_mul_ps(Dx, Rx), Zero));
+			Reject = _mm_or_ps(Reject, _mm_and_ps(_mm_cmpgt_ps(PacketAbs(Dy), Ey), _mm_cmpge_ps(_mm_mul_ps(Dy, Ry), Zero)));
+			Reject = _mm_or_ps(Reject, _mm_and_ps(_mm_cmpgt_ps(PacketAbs(Dz), Ez), _mm_cmpge_ps(_mm_mul_ps(Dz, Rz), Zero)));
+		}
+
+		__m128 f;
+		f = _mm_sub_ps(_mm_mul_ps(Ry, Dz), _mm_mul_ps(Rz, Dy));
+		Reject = _mm_or_ps(Reject, _mm_cmpgt_ps(PacketAbs(f), _mm_add_ps(_mm_mul_ps(Ey, FDz), _mm_mul_ps(Ez, FDy))));
+		f = _mm_sub_ps(_mm_mul_ps(Rz, Dx), _mm_mul_ps(Rx, Dz));
+		Reject = _mm_or_ps(Reject, _mm_cmpgt_ps(PacketAbs(f), _mm_add_ps(_mm_mul_ps(Ex, FDz), _mm_mul_ps(Ez, FDx))));
+		f = _mm_sub_ps(_mm_mul_ps(Rx, Dy), _mm_mul_ps(Ry, Dx));
+		Reject = _mm_or_ps(Reject, _mm_cmpgt_ps(PacketAbs(f), _mm_add_ps(_mm_mul_ps(Ex, FDy), _mm_mul_ps(Ey, FDx))));
+
+		Overlap |= udword(_mm_movemask_ps(Reject)^15)<<i;
+	}
+#else
+	for(udword i=0;i<OPC_PACKET_SIZE;i++)
+	{
+		if(!(active&(1<<i)))	continue;
+
+		const Point FDir(mPacketFDir[0][i], mPacketFDir[1][i], mPacketFDir[2][i]);
+		float Dx, Dy, Dz;
+		Point R;
+		if(Segment)
+		{
+			Dx = mPacketData2[0][i] - center.x;		if(fabsf(Dx) > extents.x + FDir.x)	continue;
+			Dy = mPacketData2[1][i] - center.y;		if(fabsf(Dy) > extents.y + FDir.y)	continue;
+			Dz = mPacketData2[2][i] - center.z;		if(fabsf(Dz) > extents.z + FDir.z)	continue;
+			R.Set(mPacketData[0][i], mPacketData[1][i], mPacketData[2][i]);
+		}
+		else
+		{
+			R.Set(mPacketDir[0][i], mPacketDir[1][i], mPacketDir[2][i]);
+			Dx = mPacketOrigin[0][i] - center.x;	if(GREATER(Dx, extents.x) && Dx*R.x>=0.0f)	continue;
+			Dy = mPacketOrigin[1][i] - center.y;	if(GREATER(Dy, extents.y) && Dy*R.y>=0.0f)	continue;
+			Dz = mPacketOrigin[2][i] - center.z;	if(GREATER(Dz, extents.z) && Dz*R.z>=0.0f)	continue;
+		}
+
+		float f;
+		f = R.y * Dz - R.z * Dy;	if(fabsf(f) > extents.y*FDir.z + extents.z*FDir.y)	continue;
+		f = R.z * Dx - R.x * Dz;	if(fabsf(f) > extents.x*FDir.z + extents.z*FDir.x)	continue;
+		f = R.x * Dy - R.y * Dx;	if(fabsf(f) > extents.x*FDir.y + extents.y*FDir.x)	continue;
+
+		Overlap |= 1<<i;
+	}
+#endif
+	return Overlap & active;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Computes ray-triangle intersection tests for a packet of rays, using the same Möller test as RayTriOverlap(). Hits
+ *	are only reported within the distance bounds.
+ *
+ *	\param		vert0	[in] triangle vertex
+ *	\param		vert1	[in] triangle vertex
+ *	\param		vert2	[in] triangle vertex
+ *	\param		active	[in] rays to test, one bit per ray
+ *	\return		rays hitting the triangle, one bit per ray
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline_ udword RayCollider::PacketTriOverlap(const Point& vert0, const Point& vert1, const Point& vert2, udword active)
+{
+	// Stats
+	mNbRayPrimTests++;
+
+	// Find vectors for two edges sharing vert0, shared by all rays
+	const Point edge1 = vert1 - vert0;
+	const Point edge2 = vert2 - vert0;
+	const float Epsilon = LOCAL_EPSILON * FCMin2(edge1.SquareMagnitude(), edge2.SquareMagnitude());
+	const BOOL Segment = IR(mMaxDist)!=IEEE_MAX_FLOAT;
+
+	udword Hits = 0;
+#ifdef OPC_USE_AVX
+	const __m256 E1x = _mm256_set1_ps(edge1.x);	const __m256 E2x = _mm256_set1_ps(edge2.x);	const __m256 V0x = _mm256_set1_ps(vert0.x);
+	const __m256 E1y = _mm256_set1_ps(edge1.y);	const __m256 E2y = _mm256_set1_ps(edge2.y);	const __m256 V0y = _mm256_set1_ps(vert0.y);
+	const __m256 E1z = _mm256_set1_ps(edge1.z);	const __m256 E2z = _mm256_set1_ps(edge2.z);	const __m256 V0z = _mm256_set1_ps(vert0.z);
+	const __m256 One = _mm256_set1_ps(1.0f);
+
+	const __m256 Dx = _mm256_loadu_ps(mPacketDir[0]);
+	const __m256 Dy = _mm256_loadu_ps(mPacketDir[1]);
+	const __m256 Dz = _mm256_loadu_ps(mPacketDir[2]);
+
+	// pvec = dir^edge2, det = edge1|pvec
+	const __m256 Px = _mm256_sub_ps(_mm256_mul_ps(Dy, E2z), _mm256_mul_ps(Dz, E2y));
+	const __m256 Py = _mm256_sub_ps(_mm256_mul_ps(Dz, E2x), _mm256_mul_ps(Dx, E2z));
+	const __m256 Pz = _mm256_sub_ps(_mm256_mul_ps(Dx, E2y), _mm256_mul_ps(Dy, E2x));
+	const __m256 Det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(E1x, Px), _mm256_mul_ps(E1y, Py)), _mm256_mul_ps(E1z, Pz));
+
+	// tvec = origin - vert0, qvec = tvec^edge1
+	const __m256 Tx = _mm256_sub_ps(_mm256_loadu_ps(mPacketOrigin[0]), V0x);
+	const __m256 Ty = _mm256_sub_ps(_mm256_loadu_ps(mPacketOrigin[1]), V0y);
+	const __m256 Tz = _mm256_sub_ps(_mm256_loadu_ps(mPacketOrigin[2]), V0z);
+	const __m256 Qx = _mm256_sub_ps(_mm256_mul_ps(Ty, E1z), _mm256_mul_ps(Tz, E1y));
+	const __m256 Qy = _mm256_sub_ps(_mm256_mul_ps(Tz, E1x), _mm256_mul_ps(Tx, E1z));
+	const __m256 Qz = _mm256_sub_ps(_mm256_mul_ps(Tx, E1y), _mm256_mul_ps(Ty, E1x));
+
+	__m256 U = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Tx, Px), _mm256_mul_ps(Ty, Py)), _mm256_mul_ps(Tz, Pz));
+	__m256 V = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Dx, Qx), _mm256_mul_ps(Dy, Qy)), _mm256_mul_ps(Dz, Qz));
+	__m256 Dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(E2x, Qx), _mm256_mul_ps(E2y, Qy)), _mm256_mul_ps(E2z, Qz));
+	const __m256 OneOverDet = _mm256_div_ps(One, Det);
+
+	__m256 Reject;
+	if(mCulling)
+	{
+		Reject =					_mm256_cmp_ps(Det, _mm256_set1_ps(Epsilon), _CMP_LE_OQ);
+		Reject = _mm256_or_ps(Reject, _mm256_or_ps(PacketIsNegative(U), PacketIntGreater(U, Det)));
+		Reject = _mm256_or_ps(Reject, _mm256_or_ps(PacketIsNegative(V), _mm256_cmp_ps(_mm256_add_ps(U, V), Det, _CMP_GT_OQ)));
+		Reject = _mm256_or_ps(Reject, PacketIsNegative(Dist));
+		Dist = _mm256_mul_ps(Dist, OneOverDet);
+	}
+	else
+	{
+		U = _mm256_mul_ps(U, OneOverDet);
+		V = _mm256_mul_ps(V, OneOverDet);
+		Dist = _mm256_mul_ps(Dist, OneOverDet);
+		Reject =					_mm256_cmp_ps(PacketAbs(Det), _mm256_set1_ps(Epsilon), _CMP_LE_OQ);
+		Reject = _mm256_or_ps(Reject, _mm256_or_ps(PacketIsNegative(U), PacketIntGreater(U, One)));
+		Reject = _mm256_or_ps(Reject, _mm256_or_ps(PacketIsNegative(V), _mm256_cmp_ps(_mm256_add_ps(U, V), One, _CMP_GT_OQ)));
+		Reject = _mm256_or_ps(Reject, PacketIsNegative(Dist));
+	}
+
+	// Intersection point is valid if min dist < dist (< segment's length)
+	__m256 Valid = _mm256_andnot_ps(Reject, _mm256_cmp_ps(Dist, _mm256_set1_ps(mMinDist), _CMP_GT_OQ));
+	if(Segment)	Valid = _mm256_and_ps(Valid, PacketIntGreater(_mm256_set1_ps(mMaxDist), Dist));
+
+	Hits = udword(_mm256_movemask_ps(Valid));
+#elif defined(OPC_USE_SSE)
+	const __m128 E1x = _mm_set1_ps(edge1.x);	const __m128 E2x = _mm_set1_ps(edge2.x);	const __m128 V0x = _mm_set1_ps(vert0.x);
+	const __m128 E1y = _mm_set1_ps(edge1.y);	const __m128 E2y = _mm_set1_ps(edge2.y);	const __m128 V0y = _mm_set1_ps(vert0.y);
+	const __m128 E1z = _mm_set1_ps(edge1.z);	const __m128 E2z = _mm_set1_ps(edge2.z);	const __m128 V0z = _mm_set1_ps(vert0.z);
+	const __m128 Eps = _mm_set1_ps(Epsilon);
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 MinDist = _mm_set1_ps(mMinDist);
+	const __m128 MaxDist = _mm_set1_ps(mMaxDist);
+
+	for(udword i=0;i<OPC_PACKET_SIZE;i+=4)
+	{
+		if(!((active>>i)&15))	continue;
+
+		const __m128 Dx = _mm_loadu_ps(&mPacketDir[0][i]);
+		const __m128 Dy = _mm_loadu_ps(&mPacketDir[1][i]);
+		const __m128 Dz = _mm_loadu_ps(&mPacketDir[2][i]);
+
+		// pvec = dir^edge2, det = edge1|pvec
+		const __m128 Px = _mm_sub_ps(_mm_mul_ps(Dy, E2z), _mm_mul_ps(Dz, E2y));
+		const __m128 Py = _mm_sub_ps(_mm_mul_ps(Dz, E2x), _mm_mul_ps(Dx, E2z));
+		const __m128 Pz = _mm_sub_ps(_mm_mul_ps(Dx, E2y), _mm_mul_ps(Dy, E2x));
+		const __m128 Det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(E1x, Px), _mm_mul_ps(E1y, Py)), _mm_mul_ps(E1z, Pz));
+
+		// tvec = origin - vert0, qvec = tvec^edge1
+		const __m128 Tx = _mm_sub_ps(_mm_loadu_ps(&mPacketOrigin[0][i]), V0x);
+		const __m128 Ty = _mm_sub_ps(_mm_loadu_ps(&mPacketOrigin[1][i]), V0y);
+		const __m128 Tz = _mm_sub_ps(_mm_loadu_ps(&mPacketOrigin[2][i]), V0z);
+		const __m128 Qx = _mm_sub_ps(_mm_mul_ps(Ty, E1z), _mm_mul_ps(Tz, E1y));
+		const __m128 Qy = _mm_sub_ps(_mm_mul_ps(Tz, E1x), _mm_mul_ps(Tx, E1z));
+		const __m128 Qz = _mm_sub_ps(_mm_mul_ps(Tx, E1y), _mm_mul_ps(Ty, E1x));
+
+		__m128 U = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Tx, Px), _mm_mul_ps(Ty, Py)), _mm_mul_ps(Tz, Pz));
+		__m128 V = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Dx, Qx), _mm_mul_ps(Dy, Qy)), _mm_mul_ps(Dz, Qz));
+		__m128 Dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(E2x, Qx), _mm_mul_ps(E2y, Qy)), _mm_mul_ps(E2z, Qz));
+		const __m128 OneOverDet = _mm_div_ps(One, Det);
+
+		__m128 Reject;
+		if(mCulling)
+		{
+			Reject =				_mm_cmple_ps(Det, Eps);
+			Reject = _mm_or_ps(Reject, _mm_or_ps(PacketIsNegative(U), PacketIntGreater(U, Det)));
+			Reject = _mm_or_ps(Reject, _mm_or_ps(PacketIsNegative(V), _mm_cmpgt_ps(_mm_add_ps(U, V), Det)));
+			Reject = _mm_or_ps(Reject, PacketIsNegative(Dist));
+			Dist = _mm_mul_ps(Dist, OneOverDet);
+		}
+		else
+		{
+			U = _mm_mul_ps(U, OneOverDet);
+			V = _mm_mul_ps(V, OneOverDet);
+			Dist = _mm_mul_ps(Dist, OneOverDet);
+			Reject =				_mm_cmple_ps(PacketAbs(Det), Eps);
+			Reject = _mm_or_ps(Reject, _mm_or_ps(PacketIsNegative(U), PacketIntGreater(U, One)));
+			Reject = _mm_or_ps(Reject, _mm_or_ps(PacketIsNegative(V), _mm_cmpgt_ps(_mm_add_ps(U, V), One)));
+			Reject = _mm_or_ps(Reject, PacketIsNegative(Dist));
+		}
+
+		// Intersection point is valid if min dist < dist (< segment's length)
+		__m128 Valid = _mm_andnot_ps(Reject, _mm_cmpgt_ps(Dist, MinDist));
+		if(Segment)	Valid = _mm_and_ps(Valid, PacketIntGreater(MaxDist, Dist));
+
+		Hits |= udword(_mm_movemask_ps(Valid))<<i;
+	}
+#else
+	for(udword i=0;i<OPC_PACKET_SIZE;i++)
+	{
+		if(!(active&(1<<i)))	continue;
+
+		const Point Dir(mPacketDir[0][i], mPacketDir[1][i], mPacketDir[2][i]);
+		const Point Origin(mPacketOrigin[0][i], mPacketOrigin[1][i], mPacketOrigin[2][i]);
+
+		const Point pvec = Dir^edge2;
+		const float det = edge1|pvec;
+		const Point tvec = Origin - vert0;
+		const Point qvec = tvec^edge1;
+		float u, v, Distance;
+		if(mCulling)
+		{
+			if(det <= Epsilon)											continue;
+			u = tvec|pvec;
+			if(IS_NEGATIVE_FLOAT(u) || IR(u)>IR(det))					continue;
+			v = Dir|qvec;
+			if(IS_NEGATIVE_FLOAT(v) || u+v>det)							continue;
+			Distance = edge2|qvec;
+			if(IS_NEGATIVE_FLOAT(Distance))								continue;
+			Distance *= 1.0f / det;
+		}
+		else
+		{
+			if(FastFabs(det) <= Epsilon)								continue;
+			const float OneOverDet = 1.0f / det;
+			u = (tvec|pvec) * OneOverDet;
+			if(IS_NEGATIVE_FLOAT(u) || IR(u)>IEEE_1_0)					continue;
+			v = (Dir|qvec) * OneOverDet;
+			if(IS_NEGATIVE_FLOAT(v) || u+v>1.0f)						continue;
+			Distance = (edge2|qvec) * OneOverDet;
+			if(IS_NEGATIVE_FLOAT(Distance))								continue;
+		}
+
+		// Intersection point is valid if min dist < dist (< segment's length)
+		if(Distance>mMinDist && (!Segment || IR(Distance)<IR(mMaxDist)))	Hits |= 1<<i;
+	}
+#endif
+	return Hits & active;
+}
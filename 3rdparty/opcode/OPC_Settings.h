@@ -44,6 +44,19 @@
 	//! Use a callback in the ray collider
 	//#define OPC_RAYHIT_CALLBACK
 
+	//! Use SSE intrinsics for packet ray queries (define OPC_NO_SSE to use plain C++)
+#if !defined(OPC_NO_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define OPC_USE_SSE
+#endif
+
+	//! Use AVX2 intrinsics for packet ray queries, a whole packet at a time (compile with AVX2 enabled, e.g. -mavx2)
+#if defined(OPC_USE_SSE) && !defined(OPC_NO_AVX) && defined(__AVX2__)
+	#define OPC_USE_AVX
+#endif
+
+	//! Number of rays in a RayPacket
+	#define OPC_PACKET_SIZE	8
+
 	// NB: no compilation flag to enable/disable stats since they're actually needed in the box/box overlap test
 
 #endif //__OPC_SETTINGS_H__
@@ -29,6 +29,7 @@
 		SPLIT_BEST_AXIS			= (1<<2),		//!< Try largest axis, then second, then last
 		SPLIT_BALANCED			= (1<<3),		//!< Try to keep a well-balanced tree
 		SPLIT_FIFTY				= (1<<4),		//!< Arbitrary 50-50 split
+		SPLIT_SAH				= (1<<6),		//!< Binned surface area heuristic (best for ray queries)
 		// Node split
 		SPLIT_GEOM_CENTER		= (1<<5),		//!< Split at geometric center (else split in the middle)
 		//
@@ -38,10 +39,11 @@
 	//! Simple wrapper around build-related settings [Opcode 1.3]
 	struct OPCODE_API BuildSettings
 	{
-		inline_	BuildSettings() : mLimit(1), mRules(SPLIT_FORCE_DWORD)	{}
+		inline_	BuildSettings() : mLimit(1), mRules(SPLIT_FORCE_DWORD), mNbThreads(1)	{}
 
 		udword	mLimit;		//!< Limit number of primitives / node. If limit is 1, build a complete tree (2*N-1 nodes)
 		udword	mRules;		//!< Building/Splitting rules (a combination of SplittingRules flags)
+		udword	mNbThreads;	//!< Number of threads building complete trees. The builder must be thread-safe if this is > 1
 	};
 
 	class OPCODE_API AABBTreeBuilder
@@ -51,6 +53,9 @@
 													AABBTreeBuilder() :
 														mNbPrimitives(0),
 														mNodeBase(null),
+														mPrimitiveBase(null),
+														mCenters(null),
+														mBoxes(null),
 														mCount(0),
 														mNbInvalidSplits(0)		{}
 		//! Destructor
@@ -114,6 +119,10 @@
 									BuildSettings	mSettings;			//!< Splitting rules & split limit [Opcode 1.3]
 									udword			mNbPrimitives;		//!< Total number of primitives.
 									void*			mNodeBase;			//!< Address of node pool [Opcode 1.3]
+		// Scratch buffers of the SAH split, valid during AABBTree::Build
+		const						dTriIndex*		mPrimitiveBase;		//!< Start of the tree's list of primitives
+									Point*			mCenters;			//!< Primitive centers, kept in the order of the list of primitives
+									AABB*			mBoxes;				//!< Primitive boxes, kept in the order of the list of primitives
 		// Stats
 		inline_						void			SetCount(udword nb)				{ mCount=nb;				}
 		inline_						void			IncreaseCount(udword nb)		{ mCount+=nb;				}
@@ -79,6 +79,11 @@
 #endif
 
 	#include "OPC_Settings.h"
+#ifdef OPC_USE_AVX
+	#include <immintrin.h>
+#elif defined(OPC_USE_SSE)
+	#include <emmintrin.h>
+#endif
 	#include "OPC_IceHook.h"
 
 	namespace Opcode
@@ -66,12 +66,15 @@ void OptimizeTriangleOrdering(const std::size_t numVerts, const std::size_t numI
 		}
 	}
 
-	// Allocate per-vertex triangle lists, and calculate the starting score of
-	// each of the verts
+	// Lay out per-vertex triangle lists in one array, and calculate the
+	// starting score of each of the verts
+	std::vector<int32_t> triIndices(numIndices);
+	uint32_t triIndexStart = 0;
 	for(unsigned int v = 0; v < numVerts; v++)
 	{
 		VertData& curVert = vertexData[v];
-		curVert.triIndex.resize(curVert.numUnaddedReferences);
+		curVert.triIndexStart = triIndexStart;
+		triIndexStart += curVert.numUnaddedReferences;
 		curVert.score = FindVertexScore::score(curVert);
 	}
 
@@ -97,7 +100,7 @@ void OptimizeTriangleOrdering(const std::size_t numVerts, const std::size_t numI
 			VertData &curVert = vertexData[curVIdx];
 
 			// Add triangle to triangle list
-			curVert.triIndex[curVert.numReferences++] = tri;
+			triIndices[curVert.triIndexStart + curVert.numReferences++] = tri;
 
 			// Add vertex score to triangle score
 			curTri.score += curVert.score;
@@ -110,30 +113,28 @@ void OptimizeTriangleOrdering(const std::size_t numVerts, const std::size_t numI
 		CHECK_NEXT_NEXT_BEST(curTri.score, tri);
 	}
 
+	// Keep all triangles ordered by score for when there is no next best
+	TriScoreHeap scoreHeap;
+	scoreHeap.init(triangleData);
+
 	//
 	// Step 2: Start emitting triangles...this is the emit loop
 	//
-	LRUCacheModel lruCache;
+	LRUCacheModel lruCache(numPrimitives);
+	std::vector<uint32_t> trisToUpdate;
 	for(unsigned int outIdx = 0; outIdx < numIndices; /* this space intentionally left blank */ )
 	{
-		// If there is no next best triangle, than search for the next highest
-		// scored triangle that isn't in the list already
+		// If there is no next best triangle, than take the highest scored
+		// triangle that isn't in the list already. A scan over all triangles
+		// with CHECK_NEXT_BEST and CHECK_NEXT_NEXT_BEST would end with both set
+		// to the same triangle.
 		if(nextBestTriIdx < 0)
 		{
-			// TODO: Something better than linear performance here...
-			nextBestTriScore = nextNextBestTriScore = -1.0f;
-			nextBestTriIdx = nextNextBestTriIdx = -1;
-
-			for(unsigned int tri = 0; tri < numPrimitives; tri++)
-			{
-				TriData &curTri = triangleData[tri];
-
-				if(!curTri.isInList)
-				{
-					CHECK_NEXT_BEST(curTri.score, tri);
-					CHECK_NEXT_NEXT_BEST(curTri.score, tri);
-				}
-			}
+			nextBestTriIdx = nextNextBestTriIdx = scoreHeap.best();
+			if(nextBestTriIdx > -1)
+				nextBestTriScore = nextNextBestTriScore = triangleData[nextBestTriIdx].score;
+			else
+				nextBestTriScore = nextNextBestTriScore = -1.0f;
 		}
 		assert(nextBestTriIdx > -1 && "Ran out of 'nextBestTriangle' before I ran out of indices...not good.");
 
@@ -148,25 +149,25 @@ void OptimizeTriangleOrdering(const std::size_t numVerts, const std::size_t numI
 			// Update the list of triangles on the vert
 			VertData &curVert = vertexData[nextBestTri.vertIdx[i]];
 			curVert.numUnaddedReferences--;
+			int32_t *curVertTris = &triIndices[curVert.triIndexStart];
 			for(unsigned int t = 0; t < curVert.numReferences; t++)
 			{
-				if(curVert.triIndex[t] == nextBestTriIdx)
+				if(curVertTris[t] == nextBestTriIdx)
 				{
-					curVert.triIndex[t] = -1;
+					curVertTris[t] = -1;
 					break;
 				}
 			}
 
 			// Update cache
-			lruCache.useVertex(nextBestTri.vertIdx[i], &curVert);
+			lruCache.useVertex(nextBestTri.vertIdx[i]);
 		}
 		nextBestTri.isInList = true;
 
 		// Enforce cache size, this will update the cache position of all verts
 		// still in the cache. It will also update the score of the verts in the
 		// cache, and give back a list of triangle indicies that need updating.
-		std::vector<uint32_t> trisToUpdate;
-		lruCache.enforceSize(MaxSizeVertexCache, trisToUpdate);
+		lruCache.enforceSize(MaxSizeVertexCache, vertexData, triIndices, trisToUpdate);
 
 		// Now update scores for triangles that need updates, and find the new best
 		// triangle score/index
@@ -179,11 +180,15 @@ void OptimizeTriangleOrdering(const std::size_t numVerts, const std::size_t numI
 			// If this triangle isn't already emitted, re-score it
 			if(!tri.isInList)
 			{
+				const float oldScore = tri.score;
 				tri.score = 0.0f;
 
 				for(int i = 0; i < 3; i++)
 					tri.score += vertexData[tri.vertIdx[i]].score;
 
+				if(tri.score != oldScore)
+					scoreHeap.scoreChanged(*itr);
+
 				CHECK_NEXT_BEST(tri.score, *itr);
 				CHECK_NEXT_NEXT_BEST(tri.score, *itr);
 			}
@@ -218,122 +223,205 @@ void OptimizeTriangleOrdering(const std::size_t numVerts, const std::size_t numI
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 
-LRUCacheModel::~LRUCacheModel()
+void TriScoreHeap::init(const std::vector<TriData> &triData)
 {
-	for( LRUCacheEntry* entry = mCacheHead; entry != nullptr; )
+	mTriData = &triData;
+	mHeap.resize(triData.size());
+	mHeapPos.resize(triData.size());
+	for(uint32_t tri = 0; tri < triData.size(); tri++)
 	{
-		LRUCacheEntry* next = entry->next;
-		delete entry;
-		entry = next;
+		mHeap[tri] = tri;
+		mHeapPos[tri] = tri;
 	}
+
+	for(std::size_t pos = mHeap.size() / 2; pos-- > 0; )
+		siftDown(pos);
+
+	mChanged.clear();
+	mIsChanged.assign(triData.size(), false);
 }
 
 //------------------------------------------------------------------------------
 
-void LRUCacheModel::useVertex(const uint32_t vIdx, VertData *vData)
+void TriScoreHeap::scoreChanged(const uint32_t triIdx)
 {
-	LRUCacheEntry *search = mCacheHead;
-	LRUCacheEntry *last = nullptr;
+	if(!mIsChanged[triIdx])
+	{
+		mIsChanged[triIdx] = true;
+		mChanged.push_back(triIdx);
+	}
+}
 
-	while(search != nullptr)
+//------------------------------------------------------------------------------
+
+int32_t TriScoreHeap::best()
+{
+	// Emitted triangles may have been rescored before too, so update all
+	for(std::vector<uint32_t>::iterator itr = mChanged.begin(); itr != mChanged.end(); itr++)
 	{
-		if(search->vIdx == vIdx)
-			break;
+		mIsChanged[*itr] = false;
+		update(*itr);
+	}
+	mChanged.clear();
 
-		last = search;
-		search = search->next;
+	// Emitted triangles keep their last score, drop them once they come up
+	while(!mHeap.empty() && (*mTriData)[mHeap.front()].isInList)
+		remove(mHeap.front());
+
+	return mHeap.empty() ? -1 : int32_t(mHeap.front());
+}
+
+//------------------------------------------------------------------------------
+
+void TriScoreHeap::update(const uint32_t triIdx)
+{
+	const std::size_t pos = mHeapPos[triIdx];
+	assert(pos != NotInHeap && "Updating triangle that is not in the heap.");
+	siftUp(pos);
+	siftDown(mHeapPos[triIdx]);
+}
+
+//------------------------------------------------------------------------------
+
+void TriScoreHeap::remove(const uint32_t triIdx)
+{
+	const std::size_t pos = mHeapPos[triIdx];
+	assert(pos != NotInHeap && "Removing triangle that is not in the heap.");
+	mHeapPos[triIdx] = NotInHeap;
+
+	const uint32_t lastTri = mHeap.back();
+	mHeap.pop_back();
+	if(pos < mHeap.size())
+	{
+		place(pos, lastTri);
+		siftUp(pos);
+		siftDown(mHeapPos[lastTri]);
 	}
+}
+
+//------------------------------------------------------------------------------
 
-	// If this vertex wasn't found in the cache, create a new entry
-	if(search == nullptr)
+bool TriScoreHeap::higher(const uint32_t triA, const uint32_t triB) const
+{
+	const float scoreA = (*mTriData)[triA].score;
+	const float scoreB = (*mTriData)[triB].score;
+	return scoreA > scoreB || (scoreA == scoreB && triA < triB);
+}
+
+//------------------------------------------------------------------------------
+
+void TriScoreHeap::place(const std::size_t pos, const uint32_t triIdx)
+{
+	mHeap[pos] = triIdx;
+	mHeapPos[triIdx] = uint32_t(pos);
+}
+
+//------------------------------------------------------------------------------
+
+void TriScoreHeap::siftUp(std::size_t pos)
+{
+	const uint32_t triIdx = mHeap[pos];
+	while(pos > 0)
 	{
-		search = new LRUCacheEntry;
-		search->vIdx = vIdx;
-		search->vData = vData;
+		const std::size_t parent = (pos - 1) / 2;
+		if(!higher(triIdx, mHeap[parent]))
+			break;
+		place(pos, mHeap[parent]);
+		pos = parent;
 	}
+	place(pos, triIdx);
+}
+
+//------------------------------------------------------------------------------
 
-	if(search != mCacheHead)
+void TriScoreHeap::siftDown(std::size_t pos)
+{
+	const uint32_t triIdx = mHeap[pos];
+	const std::size_t size = mHeap.size();
+	for(;;)
 	{
-		// Unlink the entry from the linked list
-		if(last)
-			last->next = search->next;
+		std::size_t child = 2 * pos + 1;
+		if(child >= size)
+			break;
+		if(child + 1 < size && higher(mHeap[child + 1], mHeap[child]))
+			child++;
+		if(!higher(mHeap[child], triIdx))
+			break;
+		place(pos, mHeap[child]);
+		pos = child;
+	}
+	place(pos, triIdx);
+}
 
-		// Vertex that got passed in is now at the head of the cache
-		search->next = mCacheHead;
-		mCacheHead = search;
+//------------------------------------------------------------------------------
+
+void LRUCacheModel::useVertex(const uint32_t vIdx)
+{
+	uint32_t pos = 0;
+	while(pos < mSize && mEntries[pos] != vIdx)
+		pos++;
+
+	// If this vertex wasn't found in the cache, it gets a new entry
+	if(pos == mSize)
+	{
+		assert(mSize < MaxSizeVertexCache + 3 && "enforceSize() not called after each triangle.");
+		mSize++;
 	}
+
+	// Vertex that got passed in is now at the head of the cache
+	for(; pos > 0; pos--)
+		mEntries[pos] = mEntries[pos - 1];
+	mEntries[0] = vIdx;
 }
 
 //------------------------------------------------------------------------------
 
-void LRUCacheModel::enforceSize(const std::size_t /*maxSize*/, std::vector<uint32_t> &outTrisToUpdate)
+void LRUCacheModel::enforceSize(const std::size_t maxSize, std::vector<VertData> &vertexData, const std::vector<int32_t> &triIndices, std::vector<uint32_t> &outTrisToUpdate)
 {
+	assert(maxSize <= MaxSizeVertexCache && "Cache size out of range.");
+
 	// Clear list of triangles to update scores for
 	outTrisToUpdate.clear();
-
-	int32_t length = 0;
-	LRUCacheEntry* next = mCacheHead;
-	LRUCacheEntry* last = nullptr;
+	mStamp++;
 
 	// Run through list, up to the max size
-	while(next != nullptr && length < MaxSizeVertexCache)
+	const uint32_t length = mSize < maxSize ? mSize : uint32_t(maxSize);
+	for(uint32_t pos = 0; pos < length; pos++)
 	{
-		VertData& vData = *next->vData;
+		VertData& vData = vertexData[mEntries[pos]];
 
 		// Update cache position on verts still in cache
-		vData.cachePosition = length++;
+		vData.cachePosition = pos;
 
+		const int32_t *vTris = &triIndices[vData.triIndexStart];
 		for(unsigned int i = 0; i < vData.numReferences; i++)
 		{
-			const int32_t triIdx = vData.triIndex[i];
-			if(triIdx > -1)
+			const int32_t triIdx = vTris[i];
+			if(triIdx > -1 && mTriStamps[triIdx] != mStamp)
 			{
-				unsigned int j = 0;
-				for(; j < outTrisToUpdate.size(); j++)
-					if(outTrisToUpdate[j] == triIdx)
-						break;
-				if(j == outTrisToUpdate.size())
-					outTrisToUpdate.push_back(triIdx);
+				mTriStamps[triIdx] = mStamp;
+				outTrisToUpdate.push_back(triIdx);
 			}
 		}
 
 		// Update score
 		vData.score = FindVertexScore::score(vData);
-
-		last = next;
-		next = next->next;
 	}
 
-	assert(last);
-	// NULL out the pointer to the next entry on the last valid entry
-	last->next = nullptr;
-
-	// If next != nullptr, than we need to prune entries from the tail of the cache
-	while(next != nullptr)
-	{
-		// Update cache position on verts which are going to get tossed from cache
-		next->vData->cachePosition = -1;
-
-		LRUCacheEntry *curEntry = next;
-		next = next->next;
-
-		delete curEntry;
-	}
+	// Update cache position on verts which are getting tossed from cache
+	for(uint32_t pos = length; pos < mSize; pos++)
+		vertexData[mEntries[pos]].cachePosition = -1;
+	mSize = length;
 }
 
 //------------------------------------------------------------------------------
 
-int32_t LRUCacheModel::getCachePosition(const uint32_t vIdx)
+int32_t LRUCacheModel::getCachePosition(const uint32_t vIdx) const
 {
-	int32_t length = 0;
-	LRUCacheEntry *next = mCacheHead;
-	while(next != nullptr)
+	for(uint32_t pos = 0; pos < mSize; pos++)
 	{
-		if(next->vIdx == vIdx)
-			return length;
-
-		length++;
-		next = next->next;
+		if(mEntries[pos] == vIdx)
+			return pos;
 	}
 
 	return -1;
@@ -38,7 +38,9 @@ struct VertData
 	float score = 0.0f;
 	uint32_t numReferences = 0;
 	uint32_t numUnaddedReferences = 0;
-	std::vector<int32_t> triIndex;
+	/// First of the numReferences entries for this vertex in the shared
+	/// per-vertex triangle list. Emitted triangles are set to -1 there.
+	uint32_t triIndexStart = 0;
 };
 
 struct TriData
@@ -48,24 +50,56 @@ struct TriData
 	uint32_t vertIdx[3] = {0, 0, 0};
 };
 
+/// Vertex cache with the most recently used vertex first. Holds up to three
+/// vertices more than MaxSizeVertexCache, until enforceSize() is called
+/// after each triangle.
 class LRUCacheModel
 {
-	struct LRUCacheEntry
-	{
-		LRUCacheEntry *next = nullptr;
-		uint32_t vIdx = 0;
-		VertData *vData = nullptr;
-	};
+	uint32_t mEntries[MaxSizeVertexCache + 3];
+	uint32_t mSize = 0;
 
-	LRUCacheEntry *mCacheHead = nullptr;
+	// Per-triangle stamp of the last enforceSize() that reported the triangle
+	std::vector<uint32_t> mTriStamps;
+	uint32_t mStamp = 0;
 
 public:
-	~LRUCacheModel();
-	void enforceSize(const std::size_t maxSize, std::vector<uint32_t> &outTrisToUpdate);
-	void useVertex(const uint32_t vIdx, VertData *vData);
-	int32_t getCachePosition(const uint32_t vIdx);
+	explicit LRUCacheModel(const std::size_t numPrimitives) : mTriStamps(numPrimitives, 0) {}
+	void enforceSize(const std::size_t maxSize, std::vector<VertData> &vertexData, const std::vector<int32_t> &triIndices, std::vector<uint32_t> &outTrisToUpdate);
+	void useVertex(const uint32_t vIdx);
+	int32_t getCachePosition(const uint32_t vIdx) const;
 };
 
+/// Indexed max-heap of the triangles that have not been emitted yet, ordered
+/// by score. Among equal scores the lowest triangle index comes first, which
+/// is the triangle a linear scan over all triangles would pick.
+///
+/// Score changes and emitted triangles are only applied to the heap when the
+/// best triangle is requested, so triangles rescored many times in between
+/// are sifted only once.
+class TriScoreHeap
+{
+	static const uint32_t NotInHeap = ~uint32_t(0);
+
+	const std::vector<TriData> *mTriData = nullptr;
+	std::vector<uint32_t> mHeap;
+	std::vector<uint32_t> mHeapPos;
+	std::vector<uint32_t> mChanged;
+	std::vector<bool> mIsChanged;
+
+	bool higher(const uint32_t triA, const uint32_t triB) const;
+	void place(const std::size_t pos, const uint32_t triIdx);
+	void siftUp(std::size_t pos);
+	void siftDown(std::size_t pos);
+	void update(const uint32_t triIdx);
+	void remove(const uint32_t triIdx);
+
+public:
+	void init(const std::vector<TriData> &triData);
+	/// Notify the heap that the score of a triangle changed
+	void scoreChanged(const uint32_t triIdx);
+	/// @return Highest scored triangle that is not in the list, or -1 if all are
+	int32_t best();
+};
 
 /// This method will look at the index buffer for a triangle list, and generate
 /// a new index buffer which is optimized using Tom Forsyth's paper:
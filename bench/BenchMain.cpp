@@ -0,0 +1,66 @@
+/*	BenchMain.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Benchmark.h"
+
+#include <molecular/util/CommandLineParser.h>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace molecular;
+using namespace molecular::util;
+
+int main(int argc, char** argv)
+{
+	CommandLineParser cmd;
+	CommandLineParser::Option<std::string> filter(cmd, "filter", "Only run benchmarks whose name with arguments contains this string, e.g. \"BM_RayCollide/4\"");
+	CommandLineParser::Option<float> minTime(cmd, "min-time", "Minimum measured time per benchmark in seconds", 0.5f);
+	CommandLineParser::Flag list(cmd, "list", "List benchmarks without running them");
+	CommandLineParser::HelpFlag help(cmd);
+
+	try
+	{
+		cmd.Parse(argc, argv);
+		if(list)
+		{
+			Benchmark::List(std::cout);
+			return EXIT_SUCCESS;
+		}
+
+		const unsigned int numRun = Benchmark::RunAll(std::cout, filter ? *filter : std::string(), *minTime);
+		if(numRun == 0)
+		{
+			std::cerr << "molecularmeshbench: No benchmark matches the filter" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	catch(std::exception& e)
+	{
+		std::cerr << "molecularmeshbench: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*	Benchmark.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace molecular
+{
+namespace Benchmark
+{
+
+State::State(uint64_t iterations, const std::vector<int64_t>& args) :
+	mIterations(iterations),
+	mArgs(args)
+{
+}
+
+State::Iterator State::begin()
+{
+	ResumeTiming();
+	return Iterator(this, mIterations);
+}
+
+int64_t State::GetRange(size_t index) const
+{
+	if(index >= mArgs.size())
+		throw std::out_of_range("Benchmark argument not registered");
+	return mArgs[index];
+}
+
+void State::PauseTiming()
+{
+	if(!mTiming)
+		return;
+	mElapsed += Clock::now() - mStart;
+	mTiming = false;
+}
+
+void State::ResumeTiming()
+{
+	if(mTiming)
+		return;
+	mTiming = true;
+	mStart = Clock::now();
+}
+
+void State::StopRunning()
+{
+	PauseTiming();
+}
+
+/// All registered benchmarks, constructed on first use because registration happens during static initialization
+static std::vector<std::unique_ptr<Definition>>& GetDefinitions()
+{
+	static std::vector<std::unique_ptr<Definition>> definitions;
+	return definitions;
+}
+
+Definition* Register(const std::string& name, const Function& function)
+{
+	GetDefinitions().emplace_back(new Definition(name, function));
+	return GetDefinitions().back().get();
+}
+
+/// Benchmark name with arguments appended, e.g. "BM_Example/1000"
+static std::string GetRunName(const Definition& definition, const std::vector<int64_t>& args)
+{
+	std::ostringstream name;
+	name << definition.GetName();
+	for(int64_t arg: args)
+		name << "/" << arg;
+	return name.str();
+}
+
+/// Argument sets of a definition, one empty set if it has none
+static std::vector<std::vector<int64_t>> GetRuns(const Definition& definition)
+{
+	if(definition.GetArgs().empty())
+		return {std::vector<int64_t>()};
+	return definition.GetArgs();
+}
+
+/// Format value with SI prefix, e.g. 1.5M
+static std::string FormatRate(double value, const char* unit)
+{
+	static const char* kPrefixes[] = {"", "k", "M", "G", "T"};
+	int prefix = 0;
+	while(value >= 1000.0 && prefix < 4)
+	{
+		value /= 1000.0;
+		prefix++;
+	}
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(value < 10.0 ? 2 : 1) << value << kPrefixes[prefix] << unit;
+	return out.str();
+}
+
+/// Format time per iteration with a suitable unit
+static std::string FormatTime(double seconds)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	if(seconds < 1e-6)
+		out << seconds * 1e9 << " ns";
+	else if(seconds < 1e-3)
+		out << seconds * 1e6 << " us";
+	else if(seconds < 1.0)
+		out << seconds * 1e3 << " ms";
+	else
+		out << std::setprecision(3) << seconds << " s";
+	return out.str();
+}
+
+/// Run benchmark with increasing iteration counts until it takes at least minTime
+static State Run(const Definition& definition, const std::vector<int64_t>& args, double minTime)
+{
+	const uint64_t kMaxIterations = 1000000000;
+	uint64_t iterations = definition.GetIterations() ? definition.GetIterations() : 1;
+	while(true)
+	{
+		State state(iterations, args);
+		definition.GetFunction()(state);
+		const double elapsed = state.GetElapsedTime();
+		if(definition.GetIterations() || elapsed >= minTime || iterations >= kMaxIterations)
+			return state;
+
+		// Aim 40% above the minimum time, but grow at most tenfold when the estimate is unreliable:
+		double multiplier = minTime * 1.4 / std::max(elapsed, 1e-9);
+		if(elapsed < minTime * 0.1)
+			multiplier = std::min(multiplier, 10.0);
+		const double next = std::max(double(iterations + 1), iterations * multiplier);
+		iterations = uint64_t(std::min(next, double(kMaxIterations)));
+	}
+}
+
+unsigned int RunAll(std::ostream& out, const std::string& filter, double minTime)
+{
+	const std::ios::fmtflags flags = out.flags();
+	out << std::left << std::setw(44) << "benchmark" << std::right
+			<< std::setw(14) << "time"
+			<< std::setw(12) << "iterations"
+			<< std::setw(14) << "items/s"
+			<< std::setw(14) << "bytes/s" << "\n";
+
+	unsigned int numRun = 0;
+	for(auto& definition: GetDefinitions())
+	{
+		for(auto& args: GetRuns(*definition))
+		{
+			const std::string name = GetRunName(*definition, args);
+			if(name.find(filter) == std::string::npos)
+				continue;
+
+			out << std::left << std::setw(44) << name << std::right << std::flush;
+			try
+			{
+				State state = Run(*definition, args, minTime);
+				const double seconds = state.GetElapsedTime();
+				out << std::setw(14) << FormatTime(seconds / state.GetIterations())
+						<< std::setw(12) << state.GetIterations()
+						<< std::setw(14) << (state.GetItemsProcessed() ? FormatRate(state.GetItemsProcessed() / seconds, "") : "")
+						<< std::setw(14) << (state.GetBytesProcessed() ? FormatRate(state.GetBytesProcessed() / seconds, "B") : "");
+				if(!state.GetLabel().empty())
+					out << "  " << state.GetLabel();
+				out << std::endl;
+			}
+			catch(std::exception& e)
+			{
+				out << "  ERROR: " << e.what() << std::endl;
+			}
+			numRun++;
+		}
+	}
+	out.flags(flags);
+	return numRun;
+}
+
+void List(std::ostream& out)
+{
+	for(auto& definition: GetDefinitions())
+	{
+		for(auto& args: GetRuns(*definition))
+			out << GetRunName(*definition, args) << "\n";
+	}
+	out.flush();
+}
+
+}
+} // namespace molecular
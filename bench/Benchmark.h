@@ -0,0 +1,212 @@
+/*	Benchmark.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_BENCHMARK_H
+#define MOLECULAR_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MOLECULAR_BENCHMARK_UNUSED __attribute__((unused))
+#else
+#define MOLECULAR_BENCHMARK_UNUSED
+#endif
+
+namespace molecular
+{
+
+/// Minimal microbenchmark harness modelled after Google Benchmark
+/** Benchmarks are functions taking a State, registered with MOLECULAR_BENCHMARK. Setup code runs before the loop over
+	the state and is not timed:
+	@code
+	static void BM_Example(Benchmark::State& state)
+	{
+		auto input = MakeInput(state.GetRange(0));
+		for(auto _: state)
+			Benchmark::DoNotOptimize(Process(input));
+		state.SetItemsProcessed(state.GetIterations() * input.size());
+	}
+	MOLECULAR_BENCHMARK(BM_Example)->Arg(1000)->Arg(100000);
+	@endcode */
+namespace Benchmark
+{
+
+/// Iteration count, arguments, timer and counters of one benchmark run
+class State
+{
+public:
+	/// Loop variable of range-based for loops, not meant to be used
+	struct MOLECULAR_BENCHMARK_UNUSED Value {};
+
+	class Iterator
+	{
+	public:
+		Iterator(State* state, uint64_t remaining) : mState(state), mRemaining(remaining) {}
+
+		Value operator*() const {return Value();}
+		Iterator& operator++() {--mRemaining; return *this;}
+
+		/// Stops the timer once all iterations are done
+		bool operator!=(const Iterator&)
+		{
+			if(mRemaining > 0)
+				return true;
+			mState->StopRunning();
+			return false;
+		}
+
+	private:
+		State* mState;
+		uint64_t mRemaining;
+	};
+
+	State(uint64_t iterations, const std::vector<int64_t>& args);
+
+	/// Start timing and iterating
+	Iterator begin();
+	Iterator end() {return Iterator(this, 0);}
+
+	/// Argument registered with Benchmark::Definition::Arg or Args
+	int64_t GetRange(size_t index = 0) const;
+
+	uint64_t GetIterations() const {return mIterations;}
+
+	/// Exclude work inside the loop from the measurement, e.g. restoring input modified by the previous iteration
+	void PauseTiming();
+	void ResumeTiming();
+
+	/// Total number of items processed by all iterations, reported as items per second
+	void SetItemsProcessed(int64_t items) {mItemsProcessed = items;}
+
+	/// Total number of bytes processed by all iterations, reported as bytes per second
+	void SetBytesProcessed(int64_t bytes) {mBytesProcessed = bytes;}
+
+	/// Additional information printed after the measurements
+	void SetLabel(const std::string& label) {mLabel = label;}
+
+	/// Measured time in seconds
+	double GetElapsedTime() const {return mElapsed.count();}
+
+	int64_t GetItemsProcessed() const {return mItemsProcessed;}
+	int64_t GetBytesProcessed() const {return mBytesProcessed;}
+	const std::string& GetLabel() const {return mLabel;}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void StopRunning();
+
+	uint64_t mIterations;
+	std::vector<int64_t> mArgs;
+	bool mTiming = false;
+	Clock::time_point mStart;
+	std::chrono::duration<double> mElapsed {0};
+	int64_t mItemsProcessed = 0;
+	int64_t mBytesProcessed = 0;
+	std::string mLabel;
+};
+
+using Function = std::function<void(State&)>;
+
+/// Registered benchmark and the argument sets it runs with
+class Definition
+{
+public:
+	Definition(const std::string& name, const Function& function) : mName(name), mFunction(function) {}
+
+	/// Add a run with a single argument
+	Definition* Arg(int64_t arg) {mArgs.push_back({arg}); return this;}
+
+	/// Add a run with multiple arguments
+	Definition* Args(const std::vector<int64_t>& args) {mArgs.push_back(args); return this;}
+
+	/// Add runs by calling function, e.g. for arguments computed in a loop
+	Definition* Apply(void (*function)(Definition*)) {function(this); return this;}
+
+	/// Fixed iteration count for slow benchmarks, instead of running until the minimum time is reached
+	Definition* Iterations(uint64_t iterations) {mIterations = iterations; return this;}
+
+	const std::string& GetName() const {return mName;}
+	const Function& GetFunction() const {return mFunction;}
+	const std::vector<std::vector<int64_t>>& GetArgs() const {return mArgs;}
+	uint64_t GetIterations() const {return mIterations;}
+
+private:
+	std::string mName;
+	Function mFunction;
+	std::vector<std::vector<int64_t>> mArgs;
+	uint64_t mIterations = 0;
+};
+
+/// Add benchmark to the global list
+/** @returns Definition to add arguments to, valid until the end of the program. */
+Definition* Register(const std::string& name, const Function& function);
+
+/// Run all registered benchmarks whose name with arguments contains filter
+/** Each benchmark runs with increasing iteration counts until the timed part takes at least minTime seconds.
+	@returns Number of benchmarks run. */
+unsigned int RunAll(std::ostream& out, const std::string& filter = std::string(), double minTime = 0.5);
+
+/// Print names with arguments of all registered benchmarks
+void List(std::ostream& out);
+
+/// Keep compiler from removing the computation of value
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+/// Keep compiler from assuming that memory is unchanged or unused
+inline void ClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : : "memory");
+#endif
+}
+
+}
+
+} // namespace molecular
+
+#define MOLECULAR_BENCHMARK_CONCAT2(a, b) a##b
+#define MOLECULAR_BENCHMARK_CONCAT(a, b) MOLECULAR_BENCHMARK_CONCAT2(a, b)
+
+/// Register benchmark function at static initialization
+#define MOLECULAR_BENCHMARK(function) \
+	static molecular::Benchmark::Definition* MOLECULAR_BENCHMARK_CONCAT(gBenchmark, __LINE__) MOLECULAR_BENCHMARK_UNUSED \
+		= molecular::Benchmark::Register(#function, function)
+
+#endif // MOLECULAR_BENCHMARK_H
@@ -0,0 +1,619 @@
+/*	CompilerBenchmarks.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include "MeshGenerators.h"
+
+#include "compiler/ColladaFile.h"
+#include "compiler/ColladaToMesh.h"
+#include "compiler/MeshAnalysis.h"
+#include "compiler/MeshCompiler.h"
+#include "compiler/Meshlets.h"
+#include "compiler/NumberParser.h"
+#include "compiler/OverdrawOptimizer.h"
+#include "compiler/PrecomputedRadianceTransfer.h"
+#include "compiler/Simplifier.h"
+#include "compiler/VertexFetchOptimizer.h"
+#include "triListOpt.h"
+
+#include <molecular/util/FileStreamStorage.h>
+#include <molecular/util/MeshUtils.h>
+
+#include <Opcode.h>
+#undef for
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+using namespace molecular;
+using namespace molecular::util;
+using namespace molecular::MeshGenerators;
+
+static void BM_ReadFloatArray(Benchmark::State& state)
+{
+	const size_t count = state.GetRange(0);
+	const std::string text = MakeFloatArrayText(count);
+	for(auto _: state)
+		Benchmark::DoNotOptimize(NumberParser::ReadFloatArray(text.c_str(), count));
+	state.SetItemsProcessed(state.GetIterations() * count);
+	state.SetBytesProcessed(state.GetIterations() * text.size());
+}
+MOLECULAR_BENCHMARK(BM_ReadFloatArray)->Arg(1000)->Arg(1000000);
+
+/// Number parsing of the COLLADA reader before NumberParser
+namespace PreviousParser
+{
+
+static std::vector<float> ReadFloatArray(const char* text)
+{
+	std::vector<float> out;
+	const char* beginPtr = text;
+	char* endPtr = nullptr;
+	while(true)
+	{
+		float value = strtof(beginPtr, &endPtr);
+		if(beginPtr == endPtr)
+			break;
+		out.push_back(value);
+		beginPtr = endPtr;
+	}
+	return out;
+}
+
+static std::vector<int> ReadIntArray(const char* text)
+{
+	std::vector<int> out;
+	const char* beginPtr = text;
+	char* endPtr = nullptr;
+	while(true)
+	{
+		int value = strtol(beginPtr, &endPtr, 0);
+		if(beginPtr == endPtr)
+			break;
+		out.push_back(value);
+		beginPtr = endPtr;
+	}
+	return out;
+}
+
+}
+
+/// Baseline for BM_ReadFloatArray
+static void BM_ReadFloatArrayStrtof(Benchmark::State& state)
+{
+	const size_t count = state.GetRange(0);
+	const std::string text = MakeFloatArrayText(count);
+	for(auto _: state)
+		Benchmark::DoNotOptimize(PreviousParser::ReadFloatArray(text.c_str()));
+	state.SetItemsProcessed(state.GetIterations() * count);
+	state.SetBytesProcessed(state.GetIterations() * text.size());
+}
+MOLECULAR_BENCHMARK(BM_ReadFloatArrayStrtof)->Arg(1000)->Arg(1000000);
+
+static void BM_ReadIntArray(Benchmark::State& state)
+{
+	const size_t count = state.GetRange(0);
+	const std::string text = MakeIntArrayText(count, 100000);
+	for(auto _: state)
+		Benchmark::DoNotOptimize(NumberParser::ReadIntArray(text.c_str(), count));
+	state.SetItemsProcessed(state.GetIterations() * count);
+	state.SetBytesProcessed(state.GetIterations() * text.size());
+}
+MOLECULAR_BENCHMARK(BM_ReadIntArray)->Arg(1000)->Arg(1000000);
+
+/// Baseline for BM_ReadIntArray
+static void BM_ReadIntArrayStrtol(Benchmark::State& state)
+{
+	const size_t count = state.GetRange(0);
+	const std::string text = MakeIntArrayText(count, 100000);
+	for(auto _: state)
+		Benchmark::DoNotOptimize(PreviousParser::ReadIntArray(text.c_str()));
+	state.SetItemsProcessed(state.GetIterations() * count);
+	state.SetBytesProcessed(state.GetIterations() * text.size());
+}
+MOLECULAR_BENCHMARK(BM_ReadIntArrayStrtol)->Arg(1000)->Arg(1000000);
+
+/// COLLADA export of a flat shaded sphere with roughly 2 * size * size triangles
+static std::string MakeColladaSphere(unsigned int size)
+{
+	return MakeColladaText(ToSeparateIndices(MakeSphere(size, size)));
+}
+
+/// Import of a generated .dae file as done by the compiler, from file contents to MeshSet
+/** Arguments: sphere size */
+static void BM_LoadCollada(Benchmark::State& state)
+{
+	const std::string text = MakeColladaSphere(state.GetRange(0));
+	std::vector<char> contents;
+	size_t numVertices = 0;
+	for(auto _: state)
+	{
+		// The document is parsed in place:
+		state.PauseTiming();
+		contents.assign(text.begin(), text.end());
+		state.ResumeTiming();
+		ColladaFile file(contents.data(), contents.size());
+		const MeshSet meshes = meshfile::ColladaToMesh::ToMesh(file);
+		numVertices = meshes.front().GetNumVertices();
+		Benchmark::DoNotOptimize(meshes);
+	}
+	state.SetBytesProcessed(state.GetIterations() * text.size());
+	std::ostringstream label;
+	label << text.size() / 1000000 << " MB, " << numVertices << " vertices";
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_LoadCollada)->Arg(64)->Arg(512);
+
+/// Number arrays of a COLLADA document with the size hints the reader passes to NumberParser
+struct ColladaArrays
+{
+	std::vector<std::string> floatArrays;
+	std::vector<size_t> floatCounts;
+	std::vector<std::string> intArrays; ///< Primitive lists
+	std::vector<size_t> intCounts;
+
+	size_t GetSize() const
+	{
+		size_t size = 0;
+		for(auto& text: floatArrays)
+			size += text.size();
+		for(auto& text: intArrays)
+			size += text.size();
+		return size;
+	}
+};
+
+static void CollectArrays(pugi::xml_node node, ColladaArrays& out)
+{
+	for(auto child: node.children())
+	{
+		if(std::strcmp(child.name(), "float_array") == 0)
+		{
+			out.floatArrays.push_back(child.child_value());
+			out.floatCounts.push_back(child.attribute("count").as_uint());
+		}
+		else if(std::strcmp(child.name(), "p") == 0)
+		{
+			const size_t numInputs = std::distance(node.children("input").begin(), node.children("input").end());
+			out.intArrays.push_back(child.child_value());
+			out.intCounts.push_back(node.attribute("count").as_uint() * size_t(3) * numInputs);
+		}
+		else
+			CollectArrays(child, out);
+	}
+}
+
+static ColladaArrays GetColladaArrays(const std::string& text)
+{
+	pugi::xml_document document;
+	if(!document.load_string(text.c_str()))
+		throw std::runtime_error("Could not parse generated COLLADA document");
+	ColladaArrays arrays;
+	CollectArrays(document, arrays);
+	return arrays;
+}
+
+/// Number parsing part of BM_LoadCollada, on the same file
+/** The previous parser cannot be linked into the COLLADA reader alongside NumberParser. Comparing this against
+	BM_ReadColladaArraysStrtof gives the difference in load time. Arguments: sphere size */
+static void BM_ReadColladaArrays(Benchmark::State& state)
+{
+	const ColladaArrays arrays = GetColladaArrays(MakeColladaSphere(state.GetRange(0)));
+	for(auto _: state)
+	{
+		for(size_t i = 0; i < arrays.floatArrays.size(); ++i)
+			Benchmark::DoNotOptimize(NumberParser::ReadFloatArray(arrays.floatArrays[i].c_str(), arrays.floatCounts[i]));
+		for(size_t i = 0; i < arrays.intArrays.size(); ++i)
+			Benchmark::DoNotOptimize(NumberParser::ReadIntArray(arrays.intArrays[i].c_str(), arrays.intCounts[i]));
+	}
+	state.SetBytesProcessed(state.GetIterations() * arrays.GetSize());
+}
+MOLECULAR_BENCHMARK(BM_ReadColladaArrays)->Arg(64)->Arg(512);
+
+/// Baseline for BM_ReadColladaArrays
+static void BM_ReadColladaArraysStrtof(Benchmark::State& state)
+{
+	const ColladaArrays arrays = GetColladaArrays(MakeColladaSphere(state.GetRange(0)));
+	for(auto _: state)
+	{
+		for(auto& text: arrays.floatArrays)
+			Benchmark::DoNotOptimize(PreviousParser::ReadFloatArray(text.c_str()));
+		for(auto& text: arrays.intArrays)
+			Benchmark::DoNotOptimize(PreviousParser::ReadIntArray(text.c_str()));
+	}
+	state.SetBytesProcessed(state.GetIterations() * arrays.GetSize());
+}
+MOLECULAR_BENCHMARK(BM_ReadColladaArraysStrtof)->Arg(64)->Arg(512);
+
+/// Flat shaded sphere, every position is split into one vertex per adjacent face
+static void BM_SeparateToUnifiedIndices(Benchmark::State& state)
+{
+	const SeparateIndexMesh in = ToSeparateIndices(MakeSphere(state.GetRange(0), state.GetRange(0)));
+	size_t numVertices = 0;
+	for(auto _: state)
+	{
+		std::vector<uint32_t> outIndices;
+		std::vector<Vector3> outPositions;
+		std::vector<Vector3> outNormals;
+		std::vector<Vector2> outUvs;
+		MeshUtils::SeparateToUnifiedIndices(
+					in.positionIndices.size(),
+					in.positionIndices.data(),
+					in.normalIndices.data(),
+					in.texCoordIndices.data(),
+					in.positions.size(),
+					in.positions.data(),
+					in.normals.size(),
+					in.normals.data(),
+					in.texCoords.size(),
+					in.texCoords.data(),
+					outIndices,
+					outPositions,
+					outNormals,
+					outUvs);
+		numVertices = outPositions.size();
+		Benchmark::DoNotOptimize(outIndices);
+	}
+	state.SetItemsProcessed(state.GetIterations() * in.positionIndices.size());
+	std::ostringstream label;
+	label << in.positions.size() << " -> " << numVertices << " vertices";
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_SeparateToUnifiedIndices)->Arg(64)->Arg(512);
+
+/// Arguments: mesh kind, size
+static void BM_OptimizeTriangleOrdering(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	const SyntheticMesh mesh = MakeMesh(kind, state.GetRange(1));
+	std::vector<TriListOpt::IndexType> out(mesh.indices.size());
+	for(auto _: state)
+	{
+		TriListOpt::OptimizeTriangleOrdering(mesh.positions.size(), mesh.indices.size(), mesh.indices.data(), out.data());
+		Benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.GetNumTriangles());
+	std::ostringstream label;
+	label.precision(3);
+	label << GetName(kind) << ", ACMR " << MeshAnalysis::CalculateAcmr(mesh.indices.data(), mesh.indices.size(), mesh.positions.size())
+			<< " -> " << MeshAnalysis::CalculateAcmr(out.data(), out.size(), mesh.positions.size());
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_OptimizeTriangleOrdering)
+		->Args({int(MeshKind::kGrid), 256})
+		->Args({int(MeshKind::kNoisyScan), 256})
+		->Args({int(MeshKind::kSkinnedCharacter), 256});
+
+/// Arguments: mesh kind, size
+static void BM_OptimizeVertexFetch(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	SyntheticMesh mesh = MakeMesh(kind, state.GetRange(1));
+	TriListOpt::OptimizeTriangleOrdering(mesh.positions.size(), mesh.indices.size(), mesh.indices.data(), mesh.indices.data());
+	std::vector<uint32_t> indices;
+	for(auto _: state)
+	{
+		state.PauseTiming();
+		indices = mesh.indices;
+		state.ResumeTiming();
+		Benchmark::DoNotOptimize(VertexFetchOptimizer::Optimize(indices.data(), indices.size(), mesh.positions.size()));
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.indices.size());
+	std::ostringstream label;
+	label.precision(3);
+	label << GetName(kind) << ", overfetch " << MeshAnalysis::CalculateOverfetch(mesh.indices.data(), mesh.indices.size(), mesh.positions.size(), 32)
+			<< " -> " << MeshAnalysis::CalculateOverfetch(indices.data(), indices.size(), mesh.positions.size(), 32);
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_OptimizeVertexFetch)
+		->Args({int(MeshKind::kGrid), 256})
+		->Args({int(MeshKind::kNoisyScan), 256});
+
+/// Arguments: mesh kind, size, ACMR threshold in percent
+static void BM_OptimizeOverdraw(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	SyntheticMesh mesh = MakeMesh(kind, state.GetRange(1));
+	const float threshold = state.GetRange(2) / 100.0f;
+	TriListOpt::OptimizeTriangleOrdering(mesh.positions.size(), mesh.indices.size(), mesh.indices.data(), mesh.indices.data());
+	std::vector<uint32_t> indices;
+	for(auto _: state)
+	{
+		indices = OverdrawOptimizer::Optimize(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), mesh.positions.size(), threshold);
+		Benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.GetNumTriangles());
+	std::ostringstream label;
+	label.precision(3);
+	label << GetName(kind) << ", ACMR " << MeshAnalysis::CalculateAcmr(mesh.indices.data(), mesh.indices.size(), mesh.positions.size())
+			<< " -> " << MeshAnalysis::CalculateAcmr(indices.data(), indices.size(), mesh.positions.size())
+			<< ", overdraw " << MeshAnalysis::EstimateOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), mesh.positions.size())
+			<< " -> " << MeshAnalysis::EstimateOverdraw(indices.data(), indices.size(), mesh.positions.data(), mesh.positions.size());
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_OptimizeOverdraw)
+		->Args({int(MeshKind::kGrid), 256, 105})
+		->Args({int(MeshKind::kNoisyScan), 256, 105})
+		->Args({int(MeshKind::kNoisyScan), 256, 120});
+
+/// Arguments: mesh kind, size
+static void BM_BuildMeshlets(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	SyntheticMesh mesh = MakeMesh(kind, state.GetRange(1));
+	TriListOpt::OptimizeTriangleOrdering(mesh.positions.size(), mesh.indices.size(), mesh.indices.data(), mesh.indices.data());
+	size_t numMeshlets = 0;
+	for(auto _: state)
+	{
+		const auto meshlets = Meshlets::Build(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), mesh.positions.size());
+		numMeshlets = meshlets.size();
+		Benchmark::DoNotOptimize(meshlets);
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.GetNumTriangles());
+	std::ostringstream label;
+	label.precision(3);
+	label << GetName(kind) << ", " << numMeshlets << " meshlets, " << double(mesh.GetNumTriangles()) / numMeshlets << " triangles each";
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_BuildMeshlets)
+		->Args({int(MeshKind::kGrid), 256})
+		->Args({int(MeshKind::kNoisyScan), 256});
+
+/// Tree build rules compared by the Opcode benchmarks
+static const struct
+{
+	const char* name;
+	udword rules;
+} kSplitRules[] = {
+	{"largest axis", Opcode::SPLIT_LARGEST_AXIS | Opcode::SPLIT_GEOM_CENTER},
+	{"splatter points", Opcode::SPLIT_SPLATTER_POINTS | Opcode::SPLIT_GEOM_CENTER},
+	{"best axis", Opcode::SPLIT_BEST_AXIS},
+	{"balanced", Opcode::SPLIT_BALANCED | Opcode::SPLIT_GEOM_CENTER},
+	{"surface area heuristic", Opcode::SPLIT_SAH},
+	{"fifty-fifty", Opcode::SPLIT_FIFTY}
+};
+
+/// Register one run per entry of kSplitRules, on a noisy scan of size 256
+static void AllSplitRules(Benchmark::Definition* definition)
+{
+	for(size_t rule = 0; rule < sizeof(kSplitRules) / sizeof(kSplitRules[0]); ++rule)
+		definition->Args({int64_t(rule), 256});
+}
+
+/// Opcode mesh interface referencing the arrays of a synthetic mesh
+static void SetupMeshInterface(const SyntheticMesh& mesh, Opcode::MeshInterface& meshInterface)
+{
+	static_assert(sizeof(IceMaths::Point) == sizeof(Vector3), "Vector3 and IceMaths::Point differ");
+	meshInterface.SetNbTriangles(mesh.GetNumTriangles());
+	meshInterface.SetNbVertices(mesh.positions.size());
+	if(!meshInterface.SetPointers(reinterpret_cast<const IceMaths::IndexedTriangle*>(mesh.indices.data()),
+			reinterpret_cast<const IceMaths::Point*>(mesh.positions.data())))
+		throw std::runtime_error("Could not set mesh interface pointers");
+}
+
+static void BuildModel(Opcode::MeshInterface& meshInterface, size_t rule, Opcode::Model& model)
+{
+	Opcode::OPCODECREATE create;
+	create.mIMesh = &meshInterface;
+	create.mSettings.mRules = kSplitRules[rule].rules;
+	if(!model.Build(create))
+		throw std::runtime_error("Could not build model");
+}
+
+/// Arguments: index into kSplitRules, size of noisy scan
+static void BM_ModelBuild(Benchmark::State& state)
+{
+	const size_t rule = state.GetRange(0);
+	const SyntheticMesh mesh = MakeNoisyScan(state.GetRange(1), state.GetRange(1));
+	Opcode::MeshInterface meshInterface;
+	SetupMeshInterface(mesh, meshInterface);
+	for(auto _: state)
+	{
+		Opcode::Model model;
+		BuildModel(meshInterface, rule, model);
+		Benchmark::DoNotOptimize(model);
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.GetNumTriangles());
+	state.SetLabel(kSplitRules[rule].name);
+}
+MOLECULAR_BENCHMARK(BM_ModelBuild)->Apply(AllSplitRules);
+
+/// Shadow feeler rays as cast by the radiance transfer precomputation
+/** Groups of raysPerOrigin rays start at the same vertex. */
+struct ShadowRays
+{
+	std::vector<IceMaths::Point> origins;
+	std::vector<IceMaths::Point> directions;
+	unsigned int raysPerOrigin;
+};
+
+static ShadowRays MakeShadowRays(const SyntheticMesh& mesh, unsigned int numOrigins, unsigned int raysPerOrigin)
+{
+	std::mt19937 engine(2);
+	ShadowRays rays;
+	rays.raysPerOrigin = raysPerOrigin;
+	for(unsigned int i = 0; i < numOrigins; ++i)
+	{
+		const Vector3& position = mesh.positions[engine() % mesh.positions.size()];
+		rays.origins.push_back(IceMaths::Point(position[0], position[1], position[2]));
+		for(unsigned int j = 0; j < raysPerOrigin; ++j)
+		{
+			IceMaths::Point direction;
+			do
+			{
+				direction.Set(Random(engine, -1, 1), Random(engine, -1, 1), Random(engine, -1, 1));
+			}
+			while(direction.SquareMagnitude() > 1.0f || direction.SquareMagnitude() < 1e-4f);
+			rays.directions.push_back(direction.Normalize());
+		}
+	}
+	return rays;
+}
+
+/// Collider settings of the radiance transfer precomputation
+static void SetupCollider(Opcode::RayCollider& collider)
+{
+	collider.SetCulling(false);
+	Opcode::SetupShadowFeeler(collider, 0.01f);
+	if(const char* error = collider.ValidateSettings())
+		throw std::runtime_error(std::string("Invalid collider settings: ") + error);
+}
+
+/// Arguments: index into kSplitRules, size of noisy scan
+static void BM_RayCollide(Benchmark::State& state)
+{
+	const size_t rule = state.GetRange(0);
+	const SyntheticMesh mesh = MakeNoisyScan(state.GetRange(1), state.GetRange(1));
+	Opcode::MeshInterface meshInterface;
+	SetupMeshInterface(mesh, meshInterface);
+	Opcode::Model model;
+	BuildModel(meshInterface, rule, model);
+	const ShadowRays rays = MakeShadowRays(mesh, 256, 64);
+	Opcode::RayCollider collider;
+	SetupCollider(collider);
+
+	size_t hits = 0;
+	for(auto _: state)
+	{
+		hits = 0;
+		for(size_t i = 0; i < rays.directions.size(); ++i)
+		{
+			collider.Collide(IceMaths::Ray(rays.origins[i / rays.raysPerOrigin], rays.directions[i]), model);
+			hits += collider.GetContactStatus() ? 1 : 0;
+		}
+		Benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.GetIterations() * rays.directions.size());
+	std::ostringstream label;
+	label << kSplitRules[rule].name << ", " << hits << " of " << rays.directions.size() << " occluded";
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_RayCollide)->Apply(AllSplitRules);
+
+/// Same rays as BM_RayCollide, cast in packets sharing an origin
+static void BM_RayCollidePacket(Benchmark::State& state)
+{
+	const size_t rule = state.GetRange(0);
+	const SyntheticMesh mesh = MakeNoisyScan(state.GetRange(1), state.GetRange(1));
+	Opcode::MeshInterface meshInterface;
+	SetupMeshInterface(mesh, meshInterface);
+	Opcode::Model model;
+	BuildModel(meshInterface, rule, model);
+	const ShadowRays rays = MakeShadowRays(mesh, 256, 64);
+	Opcode::RayCollider collider;
+	SetupCollider(collider);
+
+	size_t hits = 0;
+	for(auto _: state)
+	{
+		hits = 0;
+		Opcode::RayPacket packet;
+		auto castPacket = [&]()
+		{
+			udword hitMask = 0;
+			collider.CollidePacket(packet, model, hitMask);
+			for(udword i = 0; i < packet.GetNbRays(); ++i)
+				hits += (hitMask >> i) & 1;
+			packet.Reset();
+		};
+		for(size_t i = 0; i < rays.directions.size(); ++i)
+		{
+			packet.AddRay(rays.origins[i / rays.raysPerOrigin], rays.directions[i]);
+			if(packet.IsFull() || (i + 1) % rays.raysPerOrigin == 0)
+				castPacket();
+		}
+		Benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.GetIterations() * rays.directions.size());
+	std::ostringstream label;
+	label << kSplitRules[rule].name << ", " << hits << " of " << rays.directions.size() << " occluded";
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_RayCollidePacket)->Apply(AllSplitRules);
+
+/// Arguments: mesh kind, size, number of threads
+static void BM_CalculateDiffuseShadowed(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	const Mesh mesh = MakeMesh(kind, state.GetRange(1)).ToMesh();
+	const auto samples = SphericalHarmonics::SetupSphericalSamples<3>();
+	for(auto _: state)
+	{
+		// The calculation replaces normals by transfer coefficients:
+		state.PauseTiming();
+		Mesh copy = mesh;
+		state.ResumeTiming();
+		PrecomputedRadianceTransfer::CalculateDiffuseShadowed(copy, samples, state.GetRange(2));
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.GetNumVertices());
+	state.SetLabel(GetName(kind));
+}
+MOLECULAR_BENCHMARK(BM_CalculateDiffuseShadowed)
+		->Args({int(MeshKind::kNoisyScan), 32, 1})
+		->Args({int(MeshKind::kSkinnedCharacter), 32, 1})
+		->Args({int(MeshKind::kNoisyScan), 32, 0});
+
+/// Arguments: mesh kind, size
+static void BM_Compile(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	MeshSet meshes;
+	meshes.push_back(MakeMesh(kind, state.GetRange(1)).ToMesh());
+	FileWriteStorage storage("/dev/null");
+	for(auto _: state)
+		MeshCompiler::Compile(meshes, storage);
+	state.SetItemsProcessed(state.GetIterations() * meshes.front().GetNumVertices());
+	state.SetLabel(GetName(kind));
+}
+MOLECULAR_BENCHMARK(BM_Compile)
+		->Args({int(MeshKind::kGrid), 512})
+		->Args({int(MeshKind::kSkinnedCharacter), 512});
+
+/// Arguments: mesh kind, size
+static void BM_Simplify(Benchmark::State& state)
+{
+	const MeshKind kind = MeshKind(state.GetRange(0));
+	const SyntheticMesh mesh = MakeMesh(kind, state.GetRange(1));
+	const size_t targetIndexCount = mesh.indices.size() / 6 * 3;
+	size_t numIndices = 0;
+	float error = 0.0f;
+	for(auto _: state)
+	{
+		const auto indices = Simplifier::Simplify(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), mesh.positions.size(), targetIndexCount, error);
+		numIndices = indices.size();
+		Benchmark::DoNotOptimize(indices);
+	}
+	state.SetItemsProcessed(state.GetIterations() * mesh.GetNumTriangles());
+	std::ostringstream label;
+	label.precision(3);
+	label << GetName(kind) << ", " << mesh.GetNumTriangles() << " -> " << numIndices / 3 << " triangles, error " << error;
+	state.SetLabel(label.str());
+}
+MOLECULAR_BENCHMARK(BM_Simplify)
+		->Args({int(MeshKind::kGrid), 256})
+		->Args({int(MeshKind::kSphere), 256})
+		->Args({int(MeshKind::kNoisyScan), 256});
@@ -0,0 +1,416 @@
+/*	MeshGenerators.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeshGenerators.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace molecular
+{
+namespace MeshGenerators
+{
+using namespace util;
+
+static const float kPi = 3.14159265358979323846f;
+
+Mesh SyntheticMesh::ToMesh() const
+{
+	Mesh mesh(positions.size());
+	mesh.SetAttributeData("vertexPositionAttr"_H, positions.data(), positions.size());
+	if(!normals.empty())
+		mesh.SetAttributeData("vertexNormalAttr"_H, normals.data(), normals.size());
+	if(!texCoords.empty())
+		mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, texCoords.data(), texCoords.size());
+	if(!skinWeights.empty())
+	{
+		mesh.SetAttributeData("vertexSkinWeightsAttr"_H, skinWeights.data(), skinWeights.size());
+		mesh.SetAttributeData("vertexSkinJointsAttr"_H, skinJoints.data(), skinJoints.size());
+	}
+	mesh.SetMode(IndexBufferInfo::Mode::kTriangles);
+	mesh.GetIndices() = indices;
+	return mesh;
+}
+
+float Random(std::mt19937& engine, float min, float max)
+{
+	const float unit = float(engine() >> 8) * (1.0f / 16777216.0f);
+	return min + (max - min) * unit;
+}
+
+/// Normal of the triangle, scaled by twice its area
+static Vector3 GetAreaNormal(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	const float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+	const float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+	return Vector3(u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]);
+}
+
+static Vector3 Normalize(const Vector3& v)
+{
+	const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	if(length == 0.0f)
+		return Vector3(0.0f, 1.0f, 0.0f);
+	return Vector3(v[0] / length, v[1] / length, v[2] / length);
+}
+
+/// Area weighted vertex normals
+static void CalculateNormals(SyntheticMesh& mesh)
+{
+	std::vector<Vector3> sums(mesh.positions.size(), Vector3(0.0f, 0.0f, 0.0f));
+	for(size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		const uint32_t* tri = &mesh.indices[i];
+		const Vector3 normal = GetAreaNormal(mesh.positions[tri[0]], mesh.positions[tri[1]], mesh.positions[tri[2]]);
+		for(int k = 0; k < 3; ++k)
+		{
+			Vector3& sum = sums[tri[k]];
+			sum = Vector3(sum[0] + normal[0], sum[1] + normal[1], sum[2] + normal[2]);
+		}
+	}
+	mesh.normals.resize(sums.size());
+	for(size_t i = 0; i < sums.size(); ++i)
+		mesh.normals[i] = Normalize(sums[i]);
+}
+
+/// Two triangles for each cell of a (columns + 1) x (rows + 1) vertex lattice
+/** @param skipPoles Leave out the degenerate triangles in the first and last row of a sphere. */
+static void AddLatticeTriangles(std::vector<uint32_t>& indices, unsigned int columns, unsigned int rows, bool skipPoles)
+{
+	indices.reserve(indices.size() + size_t(columns) * rows * 6);
+	for(unsigned int r = 0; r < rows; ++r)
+	{
+		for(unsigned int c = 0; c < columns; ++c)
+		{
+			const uint32_t a = r * (columns + 1) + c;
+			const uint32_t b = a + 1;
+			const uint32_t d = a + columns + 1;
+			const uint32_t e = d + 1;
+			if(!skipPoles || r > 0)
+				indices.insert(indices.end(), {a, d, b});
+			if(!skipPoles || r + 1 < rows)
+				indices.insert(indices.end(), {b, d, e});
+		}
+	}
+}
+
+const char* GetName(MeshKind kind)
+{
+	switch(kind)
+	{
+	case MeshKind::kGrid: return "grid";
+	case MeshKind::kSphere: return "sphere";
+	case MeshKind::kNoisyScan: return "noisy scan";
+	case MeshKind::kSkinnedCharacter: return "skinned character";
+	}
+	return "unknown";
+}
+
+SyntheticMesh MakeMesh(MeshKind kind, unsigned int size)
+{
+	switch(kind)
+	{
+	case MeshKind::kGrid: return MakeGrid(size, size);
+	case MeshKind::kSphere: return MakeSphere(size, size);
+	case MeshKind::kNoisyScan: return MakeNoisyScan(size, size);
+	case MeshKind::kSkinnedCharacter: return MakeSkinnedCharacter(size, size);
+	}
+	throw std::invalid_argument("Unknown mesh kind");
+}
+
+SyntheticMesh MakeGrid(unsigned int columns, unsigned int rows)
+{
+	if(columns == 0 || rows == 0)
+		throw std::invalid_argument("Grid needs at least one cell");
+
+	SyntheticMesh mesh;
+	for(unsigned int r = 0; r <= rows; ++r)
+	{
+		for(unsigned int c = 0; c <= columns; ++c)
+		{
+			const float x = float(c) / columns;
+			const float y = float(r) / rows;
+			const float z = 0.05f * std::sin(4.0f * kPi * x) * std::cos(6.0f * kPi * y);
+			mesh.positions.push_back(Vector3(x, y, z));
+			mesh.texCoords.push_back(Vector2(x, y));
+		}
+	}
+	AddLatticeTriangles(mesh.indices, columns, rows, false);
+	CalculateNormals(mesh);
+	return mesh;
+}
+
+SyntheticMesh MakeSphere(unsigned int segments, unsigned int rings)
+{
+	if(segments < 3 || rings < 2)
+		throw std::invalid_argument("Sphere needs at least 3 segments and 2 rings");
+
+	SyntheticMesh mesh;
+	for(unsigned int r = 0; r <= rings; ++r)
+	{
+		const float theta = kPi * r / rings;
+		for(unsigned int c = 0; c <= segments; ++c)
+		{
+			const float phi = 2.0f * kPi * c / segments;
+			const Vector3 position(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			mesh.positions.push_back(position);
+			mesh.normals.push_back(position);
+			mesh.texCoords.push_back(Vector2(float(c) / segments, float(r) / rings));
+		}
+	}
+	AddLatticeTriangles(mesh.indices, segments, rings, true);
+	return mesh;
+}
+
+SyntheticMesh MakeNoisyScan(unsigned int segments, unsigned int rings, uint32_t seed)
+{
+	SyntheticMesh sphere = MakeSphere(segments, rings);
+	std::mt19937 engine(seed);
+
+	// Same displacement on both sides of the seam, so the surface stays closed:
+	std::vector<float> noise(size_t(rings + 1) * segments);
+	for(auto& n: noise)
+		n = Random(engine, -0.01f, 0.01f);
+	for(unsigned int r = 0; r <= rings; ++r)
+	{
+		const float theta = kPi * r / rings;
+		for(unsigned int c = 0; c <= segments; ++c)
+		{
+			const float phi = 2.0f * kPi * c / segments;
+			const float radius = 1.0f + 0.15f * std::sin(7.0f * theta) * std::cos(5.0f * phi) + noise[r * segments + c % segments];
+			Vector3& position = sphere.positions[r * (segments + 1) + c];
+			position = Vector3(position[0] * radius, position[1] * radius, position[2] * radius);
+		}
+	}
+	sphere.texCoords.clear(); // Scans have no parametrization
+	CalculateNormals(sphere);
+
+	// Random vertex order:
+	const size_t numVertices = sphere.positions.size();
+	std::vector<uint32_t> newIndex(numVertices);
+	for(size_t i = 0; i < numVertices; ++i)
+		newIndex[i] = i;
+	for(size_t i = numVertices - 1; i > 0; --i)
+		std::swap(newIndex[i], newIndex[engine() % (i + 1)]);
+
+	SyntheticMesh mesh;
+	mesh.positions.resize(numVertices);
+	mesh.normals.resize(numVertices);
+	for(size_t i = 0; i < numVertices; ++i)
+	{
+		mesh.positions[newIndex[i]] = sphere.positions[i];
+		mesh.normals[newIndex[i]] = sphere.normals[i];
+	}
+
+	// Random triangle order:
+	const size_t numTriangles = sphere.GetNumTriangles();
+	std::vector<uint32_t> order(numTriangles);
+	for(size_t i = 0; i < numTriangles; ++i)
+		order[i] = i;
+	for(size_t i = numTriangles - 1; i > 0; --i)
+		std::swap(order[i], order[engine() % (i + 1)]);
+
+	mesh.indices.resize(sphere.indices.size());
+	for(size_t i = 0; i < numTriangles; ++i)
+	{
+		for(int k = 0; k < 3; ++k)
+			mesh.indices[i * 3 + k] = newIndex[sphere.indices[order[i] * 3 + k]];
+	}
+	return mesh;
+}
+
+SyntheticMesh MakeSkinnedCharacter(unsigned int segments, unsigned int rings, unsigned int numJoints)
+{
+	if(segments < 3 || rings == 0 || numJoints == 0)
+		throw std::invalid_argument("Character needs at least 3 segments, one ring and one joint");
+
+	const float height = 1.8f;
+	const float radius = 0.15f;
+	SyntheticMesh mesh;
+	for(unsigned int r = 0; r <= rings; ++r)
+	{
+		const float t = float(r) / rings;
+
+		// Joints sit at the centers of equally long bones:
+		const float bone = t * numJoints - 0.5f;
+		const int joint0 = std::min(std::max(int(std::floor(bone)), 0), int(numJoints) - 1);
+		const int joint1 = std::min(joint0 + 1, int(numJoints) - 1);
+		const float blend = joint0 == joint1 ? 0.0f : std::min(std::max(bone - joint0, 0.0f), 1.0f);
+
+		for(unsigned int c = 0; c <= segments; ++c)
+		{
+			const float phi = 2.0f * kPi * c / segments;
+			const float x = std::cos(phi);
+			const float z = std::sin(phi);
+			mesh.positions.push_back(Vector3(radius * x, height * t, radius * z));
+			mesh.normals.push_back(Vector3(x, 0.0f, z));
+			mesh.texCoords.push_back(Vector2(float(c) / segments, t));
+			if(blend > 0.0f)
+			{
+				mesh.skinWeights.push_back(Vector4(1.0f - blend, blend, 0.0f, 0.0f));
+				mesh.skinJoints.push_back(IntVector4(joint0, joint1, -1, -1));
+			}
+			else
+			{
+				mesh.skinWeights.push_back(Vector4(1.0f, 0.0f, 0.0f, 0.0f));
+				mesh.skinJoints.push_back(IntVector4(joint0, -1, -1, -1));
+			}
+		}
+	}
+	AddLatticeTriangles(mesh.indices, segments, rings, false);
+	return mesh;
+}
+
+SeparateIndexMesh ToSeparateIndices(const SyntheticMesh& mesh)
+{
+	SeparateIndexMesh out;
+	out.positionIndices = mesh.indices;
+	out.positions = mesh.positions;
+	if(!mesh.texCoords.empty())
+	{
+		out.texCoordIndices = mesh.indices;
+		out.texCoords = mesh.texCoords;
+	}
+
+	const size_t numTriangles = mesh.GetNumTriangles();
+	out.normals.reserve(numTriangles);
+	out.normalIndices.reserve(mesh.indices.size());
+	for(size_t i = 0; i < numTriangles; ++i)
+	{
+		const uint32_t* tri = &mesh.indices[i * 3];
+		out.normals.push_back(Normalize(GetAreaNormal(mesh.positions[tri[0]], mesh.positions[tri[1]], mesh.positions[tri[2]])));
+		out.normalIndices.insert(out.normalIndices.end(), 3, uint32_t(i));
+	}
+	return out;
+}
+
+std::string MakeFloatArrayText(size_t count, uint32_t seed)
+{
+	std::mt19937 engine(seed);
+	std::string text;
+	text.reserve(count * 10);
+	char buffer[32];
+	for(size_t i = 0; i < count; ++i)
+	{
+		std::snprintf(buffer, sizeof(buffer), i == 0 ? "%.6g" : " %.6g", Random(engine, -100.0f, 100.0f));
+		text += buffer;
+	}
+	return text;
+}
+
+std::string MakeIntArrayText(size_t count, int maxValue, uint32_t seed)
+{
+	if(maxValue <= 0)
+		throw std::invalid_argument("maxValue must be positive");
+
+	std::mt19937 engine(seed);
+	std::string text;
+	text.reserve(count * 6);
+	char buffer[16];
+	for(size_t i = 0; i < count; ++i)
+	{
+		std::snprintf(buffer, sizeof(buffer), i == 0 ? "%u" : " %u", unsigned(engine() % unsigned(maxValue)));
+		text += buffer;
+	}
+	return text;
+}
+
+/// Append values as "%.6g", separated by single spaces
+static void AppendFloats(std::string& text, const float* values, size_t count)
+{
+	char buffer[32];
+	for(size_t i = 0; i < count; ++i)
+	{
+		std::snprintf(buffer, sizeof(buffer), i == 0 ? "%.6g" : " %.6g", values[i]);
+		text += buffer;
+	}
+}
+
+/// Append source element with a float_array of count vectors with the given parameter names
+static void AppendSource(std::string& text, const char* id, const float* values, size_t count, const char* params)
+{
+	const size_t stride = std::strlen(params);
+	const std::string arrayId = std::string(id) + "-array";
+	text += "<source id=\"" + std::string(id) + "\">\n";
+	text += "<float_array id=\"" + arrayId + "\" count=\"" + std::to_string(count * stride) + "\">";
+	AppendFloats(text, values, count * stride);
+	text += "</float_array>\n<technique_common>\n";
+	text += "<accessor source=\"#" + arrayId + "\" count=\"" + std::to_string(count) + "\" stride=\"" + std::to_string(stride) + "\">\n";
+	for(const char* param = params; *param; ++param)
+		text += std::string("<param name=\"") + *param + "\" type=\"float\"/>\n";
+	text += "</accessor>\n</technique_common>\n</source>\n";
+}
+
+std::string MakeColladaText(const SeparateIndexMesh& mesh)
+{
+	const size_t numIndices = mesh.positionIndices.size();
+	if(mesh.normalIndices.size() != numIndices || (!mesh.texCoords.empty() && mesh.texCoordIndices.size() != numIndices))
+		throw std::invalid_argument("Index arrays of different length");
+
+	static_assert(sizeof(Vector3) == 3 * sizeof(float) && sizeof(Vector2) == 2 * sizeof(float), "Vectors are not tightly packed");
+
+	std::string text;
+	text.reserve((mesh.positions.size() + mesh.normals.size()) * 30 + mesh.texCoords.size() * 20 + numIndices * 20);
+	text += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n"
+			"<library_geometries>\n<geometry id=\"mesh\" name=\"mesh\">\n<mesh>\n";
+	AppendSource(text, "mesh-positions", reinterpret_cast<const float*>(mesh.positions.data()), mesh.positions.size(), "XYZ");
+	AppendSource(text, "mesh-normals", reinterpret_cast<const float*>(mesh.normals.data()), mesh.normals.size(), "XYZ");
+	if(!mesh.texCoords.empty())
+		AppendSource(text, "mesh-texcoords", reinterpret_cast<const float*>(mesh.texCoords.data()), mesh.texCoords.size(), "ST");
+	text += "<vertices id=\"mesh-vertices\">\n<input semantic=\"POSITION\" source=\"#mesh-positions\"/>\n</vertices>\n";
+	text += "<triangles count=\"" + std::to_string(numIndices / 3) + "\">\n"
+			"<input semantic=\"VERTEX\" source=\"#mesh-vertices\" offset=\"0\"/>\n"
+			"<input semantic=\"NORMAL\" source=\"#mesh-normals\" offset=\"1\"/>\n";
+	if(!mesh.texCoords.empty())
+		text += "<input semantic=\"TEXCOORD\" source=\"#mesh-texcoords\" offset=\"2\" set=\"0\"/>\n";
+	text += "<p>";
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		if(i > 0)
+			text += ' ';
+		text += std::to_string(mesh.positionIndices[i]);
+		text += ' ';
+		text += std::to_string(mesh.normalIndices[i]);
+		if(!mesh.texCoords.empty())
+		{
+			text += ' ';
+			text += std::to_string(mesh.texCoordIndices[i]);
+		}
+	}
+	text += "</p>\n</triangles>\n</mesh>\n</geometry>\n</library_geometries>\n"
+			"<library_visual_scenes>\n<visual_scene id=\"scene\" name=\"scene\">\n"
+			"<node id=\"node\" name=\"node\">\n<instance_geometry url=\"#mesh\"/>\n</node>\n"
+			"</visual_scene>\n</library_visual_scenes>\n"
+			"<scene>\n<instance_visual_scene url=\"#scene\"/>\n</scene>\n"
+			"</COLLADA>\n";
+	return text;
+}
+
+}
+} // namespace molecular
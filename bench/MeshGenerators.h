@@ -0,0 +1,124 @@
+/*	MeshGenerators.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_MESHGENERATORS_H
+#define MOLECULAR_MESHGENERATORS_H
+
+#include <molecular/util/Mesh.h>
+#include <molecular/util/Vector2.h>
+#include <molecular/util/Vector3.h>
+#include <molecular/util/Vector4.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace molecular
+{
+
+/// Synthetic benchmark input
+/** All generators are deterministic. Random numbers are derived from the raw output of std::mt19937 with fixed seeds,
+	which the standard specifies exactly, instead of from the implementation-defined standard distributions. The same
+	arguments therefore give the same meshes on every platform. */
+namespace MeshGenerators
+{
+
+/// Indexed triangle mesh with unified indices
+struct SyntheticMesh
+{
+	std::vector<uint32_t> indices;
+	std::vector<util::Vector3> positions;
+	std::vector<util::Vector3> normals;
+	std::vector<util::Vector2> texCoords;
+	std::vector<util::Vector4> skinWeights; ///< Empty unless skinned
+	std::vector<util::IntVector4> skinJoints; ///< Empty unless skinned, -1 for unused influences
+
+	size_t GetNumTriangles() const {return indices.size() / 3;}
+
+	/// Convert to Mesh with the attributes the COLLADA and OBJ converters produce
+	util::Mesh ToMesh() const;
+};
+
+/// Mesh with separate indices per attribute, as read from COLLADA or OBJ files
+struct SeparateIndexMesh
+{
+	std::vector<uint32_t> positionIndices;
+	std::vector<uint32_t> normalIndices;
+	std::vector<uint32_t> texCoordIndices;
+	std::vector<util::Vector3> positions;
+	std::vector<util::Vector3> normals;
+	std::vector<util::Vector2> texCoords;
+};
+
+enum class MeshKind
+{
+	kGrid,
+	kSphere,
+	kNoisyScan,
+	kSkinnedCharacter
+};
+
+/// Name for benchmark labels
+const char* GetName(MeshKind kind);
+
+/// Generate mesh of the given kind with roughly 2 * size * size triangles
+SyntheticMesh MakeMesh(MeshKind kind, unsigned int size);
+
+/// Wavy height field on the unit square, in the vertex order of a scan line rasterizer
+SyntheticMesh MakeGrid(unsigned int columns, unsigned int rows);
+
+/// UV sphere with radius 1, with a texture seam and no degenerate triangles at the poles
+SyntheticMesh MakeSphere(unsigned int segments, unsigned int rings);
+
+/// Bumpy sphere with positional noise, vertices and triangles in random order
+/** Resembles the output of 3D scanners and marching cubes, which has no coherent ordering. */
+SyntheticMesh MakeNoisyScan(unsigned int segments, unsigned int rings, uint32_t seed = 1);
+
+/// Upright cylinder along a chain of joints, every vertex weighted to its two nearest joints
+SyntheticMesh MakeSkinnedCharacter(unsigned int segments, unsigned int rings, unsigned int numJoints = 16);
+
+/// Flat shaded variant with one normal per triangle, positions and texture coordinates shared between triangles
+SeparateIndexMesh ToSeparateIndices(const SyntheticMesh& mesh);
+
+/// COLLADA document with a single triangle mesh instanced once in the scene
+/** Numbers are written like MakeFloatArrayText() and MakeIntArrayText() do. */
+std::string MakeColladaText(const SeparateIndexMesh& mesh);
+
+/// Whitespace separated floats as written by COLLADA exporters, with six significant digits
+std::string MakeFloatArrayText(size_t count, uint32_t seed = 1);
+
+/// Whitespace separated non-negative integers below maxValue, as in COLLADA primitive lists
+std::string MakeIntArrayText(size_t count, int maxValue, uint32_t seed = 1);
+
+/// Uniformly distributed float in [min, max)
+/** Uses 24 bits of a single engine output. */
+float Random(std::mt19937& engine, float min, float max);
+
+}
+
+} // namespace molecular
+
+#endif // MOLECULAR_MESHGENERATORS_H
@@ -0,0 +1,284 @@
+/*	RayPacketCheck.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Checks that RayCollider::CollidePacket reports the same hit for every ray as RayCollider::Collide. Built once with
+// the SSE code path, or the AVX code path with MOLECULAR_MESHFILE_AVX2, and once with the plain C++ fallback
+// (OPC_NO_SSE). With MOLECULAR_MESHFILE_AVX2 the SSE code path is checked as well.
+
+#include <Opcode.h>
+#undef for
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/// Indexed triangle mesh
+struct CheckMesh
+{
+	std::vector<uint32_t> indices;
+	std::vector<IceMaths::Point> positions;
+};
+
+/// Uniformly distributed float in [min, max), from 24 bits of a single engine output
+static float Random(std::mt19937& engine, float min, float max)
+{
+	return min + (max - min) * float(engine() >> 8) / float(1 << 24);
+}
+
+/// Closed surface: unit sphere with random radial displacement
+static CheckMesh MakeNoisySphere(unsigned int segments, unsigned int rings)
+{
+	std::mt19937 engine(1);
+	CheckMesh mesh;
+	for(unsigned int r = 0; r <= rings; ++r)
+	{
+		const float theta = 3.14159265f * r / rings;
+		for(unsigned int s = 0; s < segments; ++s)
+		{
+			const float phi = 2.0f * 3.14159265f * s / segments;
+			const float radius = 1.0f + Random(engine, -0.05f, 0.05f);
+			mesh.positions.push_back(IceMaths::Point(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+					radius * std::sin(theta) * std::sin(phi)));
+		}
+	}
+	for(unsigned int r = 0; r < rings; ++r)
+	{
+		for(unsigned int s = 0; s < segments; ++s)
+		{
+			const uint32_t a = r * segments + s, b = r * segments + (s + 1) % segments;
+			const uint32_t c = a + segments, d = b + segments;
+			mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+		}
+	}
+	return mesh;
+}
+
+/// Open surface, hit from both sides: wavy height field on [-1, 1]^2
+static CheckMesh MakeGrid(unsigned int columns, unsigned int rows)
+{
+	CheckMesh mesh;
+	for(unsigned int y = 0; y <= rows; ++y)
+	{
+		for(unsigned int x = 0; x <= columns; ++x)
+		{
+			const float u = 2.0f * x / columns - 1.0f, v = 2.0f * y / rows - 1.0f;
+			mesh.positions.push_back(IceMaths::Point(u, 0.1f * std::sin(4.0f * u) * std::cos(3.0f * v), v));
+		}
+	}
+	for(unsigned int y = 0; y < rows; ++y)
+	{
+		for(unsigned int x = 0; x < columns; ++x)
+		{
+			const uint32_t a = y * (columns + 1) + x, b = a + 1, c = a + columns + 1, d = c + 1;
+			mesh.indices.insert(mesh.indices.end(), {a, c, b, b, c, d});
+		}
+	}
+	return mesh;
+}
+
+/// Rays in the packets they are cast in
+struct RaySet
+{
+	const char* name;
+	std::vector<IceMaths::Point> origins;
+	std::vector<IceMaths::Point> directions;
+	std::vector<size_t> packetStarts; ///< First ray of each packet, followed by the total number of rays
+};
+
+static IceMaths::Point RandomDirection(std::mt19937& engine)
+{
+	IceMaths::Point direction;
+	do
+	{
+		direction.Set(Random(engine, -1, 1), Random(engine, -1, 1), Random(engine, -1, 1));
+	}
+	while(direction.SquareMagnitude() > 1.0f || direction.SquareMagnitude() < 1e-4f);
+	return direction.Normalize();
+}
+
+/// Full packets of rays starting at the same vertex, as cast by the radiance transfer precomputation
+static RaySet MakeShadowRays(const CheckMesh& mesh, unsigned int numOrigins)
+{
+	std::mt19937 engine(3);
+	RaySet rays;
+	rays.name = "shadow rays";
+	for(unsigned int i = 0; i < numOrigins; ++i)
+	{
+		const IceMaths::Point& position = mesh.positions[engine() % mesh.positions.size()];
+		rays.packetStarts.push_back(rays.origins.size());
+		for(unsigned int j = 0; j < OPC_PACKET_SIZE; ++j)
+		{
+			rays.origins.push_back(position);
+			rays.directions.push_back(RandomDirection(engine));
+		}
+	}
+	rays.packetStarts.push_back(rays.origins.size());
+	return rays;
+}
+
+/// Partially filled packets of unrelated rays starting anywhere around the mesh
+static RaySet MakeIncoherentRays(unsigned int numPackets)
+{
+	std::mt19937 engine(4);
+	RaySet rays;
+	rays.name = "incoherent rays";
+	for(unsigned int i = 0; i < numPackets; ++i)
+	{
+		rays.packetStarts.push_back(rays.origins.size());
+		const unsigned int numRays = 1 + engine() % OPC_PACKET_SIZE;
+		for(unsigned int j = 0; j < numRays; ++j)
+		{
+			rays.origins.push_back(IceMaths::Point(Random(engine, -2, 2), Random(engine, -2, 2), Random(engine, -2, 2)));
+			rays.directions.push_back(RandomDirection(engine));
+		}
+	}
+	rays.packetStarts.push_back(rays.origins.size());
+	return rays;
+}
+
+/// Collider and tree settings to check
+struct Configuration
+{
+	bool noLeaf;
+	bool quantized;
+	bool culling;
+	float maxDist; ///< MAX_FLOAT for rays, else segments
+	float minDist;
+};
+
+/// Cast all rays with both queries
+/** @returns Number of rays with different results. */
+static size_t Check(const RaySet& rays, Opcode::Model& model, const Configuration& config, size_t& hits)
+{
+	Opcode::RayCollider collider;
+	Opcode::SetupShadowFeeler(collider, config.minDist);
+	collider.SetCulling(config.culling);
+	collider.SetMaxDist(config.maxDist);
+	if(const char* error = collider.ValidateSettings())
+		throw std::runtime_error(std::string("Invalid collider settings: ") + error);
+
+	size_t mismatches = 0;
+	for(size_t p = 0; p + 1 < rays.packetStarts.size(); ++p)
+	{
+		Opcode::RayPacket packet;
+		for(size_t i = rays.packetStarts[p]; i < rays.packetStarts[p + 1]; ++i)
+			packet.AddRay(rays.origins[i], rays.directions[i]);
+		udword hitMask = 0;
+		if(!collider.CollidePacket(packet, model, hitMask))
+			throw std::runtime_error("Packet query failed");
+
+		for(size_t i = rays.packetStarts[p]; i < rays.packetStarts[p + 1]; ++i)
+		{
+			if(!collider.Collide(IceMaths::Ray(rays.origins[i], rays.directions[i]), model))
+				throw std::runtime_error("Single ray query failed");
+			const bool single = collider.GetContactStatus() != 0;
+			const bool inPacket = (hitMask >> (i - rays.packetStarts[p])) & 1;
+			hits += single ? 1 : 0;
+			if(single != inPacket)
+			{
+				if(mismatches < 5)
+				{
+					std::cerr << "  ray " << i << " (" << rays.origins[i].x << " " << rays.origins[i].y << " " << rays.origins[i].z
+							<< " -> " << rays.directions[i].x << " " << rays.directions[i].y << " " << rays.directions[i].z
+							<< "): single ray " << (single ? "hit" : "miss") << ", packet " << (inPacket ? "hit" : "miss") << "\n";
+				}
+				mismatches++;
+			}
+		}
+	}
+	return mismatches;
+}
+
+int main()
+{
+	try
+	{
+#if defined(OPC_USE_AVX)
+		std::cout << "Packet queries with AVX\n";
+#elif defined(OPC_USE_SSE)
+		std::cout << "Packet queries with SSE\n";
+#else
+		std::cout << "Packet queries without SSE\n";
+#endif
+		const CheckMesh meshes[] = {MakeNoisySphere(48, 48), MakeGrid(32, 32)};
+		const char* const meshNames[] = {"noisy sphere", "grid"};
+		size_t totalMismatches = 0;
+		for(int m = 0; m < 2; ++m)
+		{
+			const CheckMesh& mesh = meshes[m];
+			Opcode::MeshInterface meshInterface;
+			meshInterface.SetNbTriangles(mesh.indices.size() / 3);
+			meshInterface.SetNbVertices(mesh.positions.size());
+			if(!meshInterface.SetPointers(reinterpret_cast<const IceMaths::IndexedTriangle*>(mesh.indices.data()),
+					mesh.positions.data()))
+				throw std::runtime_error("Could not set mesh interface pointers");
+			const RaySet raySets[] = {MakeShadowRays(mesh, 256), MakeIncoherentRays(256)};
+
+			for(int tree = 0; tree < 4; ++tree)
+			{
+				Opcode::OPCODECREATE create;
+				create.mIMesh = &meshInterface;
+				create.mSettings.mRules = Opcode::SPLIT_SAH;
+				create.mNoLeaf = (tree & 1) != 0;
+				create.mQuantized = (tree & 2) != 0;
+				Opcode::Model model;
+				if(!model.Build(create))
+					throw std::runtime_error("Could not build model");
+
+				for(int settings = 0; settings < 8; ++settings)
+				{
+					const Configuration config = {create.mNoLeaf, create.mQuantized, (settings & 1) != 0,
+							(settings & 2) ? 0.5f : MAX_FLOAT, (settings & 4) ? 0.01f : 0.0f};
+					for(const RaySet& rays: raySets)
+					{
+						size_t hits = 0;
+						const size_t mismatches = Check(rays, model, config, hits);
+						std::cout << meshNames[m] << ", " << (config.noLeaf ? "no-leaf " : "") << (config.quantized ? "quantized " : "")
+								<< "tree, culling " << (config.culling ? "on" : "off") << ", " << (config.maxDist == MAX_FLOAT ? "rays" : "segments")
+								<< ", min distance " << config.minDist << ", " << rays.name << ": " << hits << " of "
+								<< rays.origins.size() << " hit, " << mismatches << " mismatches\n";
+						totalMismatches += mismatches;
+					}
+				}
+			}
+		}
+
+		if(totalMismatches > 0)
+		{
+			std::cerr << "molecularraypacketcheck: " << totalMismatches << " rays differ between packet and single ray queries" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	catch(std::exception& e)
+	{
+		std::cerr << "molecularraypacketcheck: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -24,9 +24,16 @@ SOFTWARE.
 */
 
 #include "ColladaFile.h"
+#include "NumberParser.h"
 #include <molecular/util/StringUtils.h>
+#include <algorithm>
 #include <stdexcept>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace molecular
 {
 namespace util
@@ -34,18 +41,89 @@ namespace util
 
 ColladaFile::ColladaFile(const char* filename)
 {
-	pugi::xml_parse_result result = mDocument.load_file(filename);
-	if(!result)
-		throw std::runtime_error(result.description());
-	mCollada = mDocument.child("COLLADA");
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0)
+		throw std::runtime_error(std::string("Cannot open ") + filename);
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+	{
+		close(fd);
+		throw std::runtime_error(std::string("Cannot stat ") + filename);
+	}
+
+	if(st.st_size > 0)
+	{
+		// Writable private mapping: the parser terminates strings in place, which only copies the touched pages
+		void* data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if(data == MAP_FAILED)
+			throw std::runtime_error(std::string("Cannot map ") + filename);
+		mMappedFile = data;
+		mMappedSize = st.st_size;
+		madvise(mMappedFile, mMappedSize, MADV_SEQUENTIAL);
+	}
+	else
+		close(fd);
+
+	try
+	{
+		Parse(mMappedFile, mMappedSize);
+	}
+	catch(...)
+	{
+		if(mMappedFile)
+			munmap(mMappedFile, mMappedSize);
+		throw;
+	}
 }
 
 ColladaFile::ColladaFile(void* fileContents, size_t size)
+{
+	Parse(fileContents, size);
+}
+
+ColladaFile::~ColladaFile()
+{
+	// Nodes point into the mapping:
+	mDocument.reset();
+	if(mMappedFile)
+		munmap(mMappedFile, mMappedSize);
+}
+
+void ColladaFile::Parse(void* fileContents, size_t size)
 {
 	pugi::xml_parse_result result = mDocument.load_buffer_inplace(fileContents, size);
 	if(!result)
 		throw std::runtime_error(result.description());
 	mCollada = mDocument.child("COLLADA");
+
+	for(auto geometry: mCollada.child("library_geometries").children("geometry"))
+	{
+		auto id = geometry.attribute("id");
+		if(!id || mGeometries.count(id.value()))
+			continue;
+		GeometryEntry& entry = mGeometries[id.value()];
+		entry.geometry = geometry;
+		for(auto child: geometry.child("mesh").children())
+		{
+			auto childId = child.attribute("id");
+			if(childId)
+				entry.meshChildren.emplace(childId.value(), child);
+		}
+	}
+	IndexChildren(mCollada.child("library_visual_scenes"), "visual_scene", mVisualScenes);
+	IndexChildren(mCollada.child("library_materials"), "material", mMaterials);
+	IndexChildren(mCollada.child("library_controllers"), "controller", mControllers);
+}
+
+void ColladaFile::IndexChildren(pugi::xml_node parent, const char* element, IdMap& index)
+{
+	for(auto child: parent.children(element))
+	{
+		auto id = child.attribute("id");
+		if(id)
+			index.emplace(id.value(), child);
+	}
 }
 
 ColladaFile::Asset ColladaFile::GetAsset() const
@@ -74,10 +152,10 @@ ColladaFile::Scene ColladaFile::GetScene() const
 
 ColladaFile::Geometry ColladaFile::GetGeometry(const char* id) const
 {
-	auto geometry = mCollada.child("library_geometries").find_child_by_attribute("geometry", "id", id);
-	if(!geometry)
+	auto it = mGeometries.find(id);
+	if(it == mGeometries.end())
 		throw std::runtime_error(std::string("Geometry ") + id + " not found");
-	return Geometry(geometry);
+	return Geometry(it->second.geometry, &it->second.meshChildren);
 }
 
 ColladaFile::Geometry ColladaFile::GetGeometryByName(const char* name) const
@@ -90,26 +168,26 @@ ColladaFile::Geometry ColladaFile::GetGeometryByName(const char* name) const
 
 ColladaFile::VisualScene ColladaFile::GetVisualScene(const char* id) const
 {
-	auto visualScene = mCollada.child("library_visual_scenes").find_child_by_attribute("visual_scene", "id", id);
-	if(!visualScene)
+	auto it = mVisualScenes.find(id);
+	if(it == mVisualScenes.end())
 		throw std::runtime_error(std::string("visual_scene \"") + id + "\" not found");
-	return VisualScene(visualScene);
+	return VisualScene(it->second);
 }
 
 ColladaFile::Material ColladaFile::GetMaterial(const char* id) const
 {
-	auto material = mCollada.child("library_materials").find_child_by_attribute("material", "id", id);
-	if(!material)
+	auto it = mMaterials.find(id);
+	if(it == mMaterials.end())
 		throw std::runtime_error(std::string("Material \"") + id + "\" not found");
-	return Material(material);
+	return Material(it->second);
 }
 
 ColladaFile::Controller ColladaFile::GetController(const char* id) const
 {
-	auto controller = mCollada.child("library_controllers").find_child_by_attribute("controller", "id", id);
-	if(!controller)
+	auto it = mControllers.find(id);
+	if(it == mControllers.end())
 		throw std::runtime_error(std::string("Controller \"") + id + "\" not found");
-	return Controller(controller);
+	return Controller(it->second);
 }
 
 std::vector<ColladaFile::Controller> ColladaFile::GetControllers() const
@@ -122,37 +200,8 @@ std::vector<ColladaFile::Controller> ColladaFile::GetControllers() const
 
 /******************************************************************************/
 
-static std::vector<float> ReadFloatArray(const char* text)
-{
-	std::vector<float> out;
-	const char* beginPtr = text;
-	char* endPtr = nullptr;
-	while(true)
-	{
-		float value = strtof(beginPtr, &endPtr);
-		if(beginPtr == endPtr)
-			break;
-		out.push_back(value);
-		beginPtr = endPtr;
-	}
-	return out;
-}
-
-static std::vector<int> ReadIntArray(const char* text)
-{
-	std::vector<int> out;
-	const char* beginPtr = text;
-	char* endPtr = nullptr;
-	while(true)
-	{
-		int value = strtol(beginPtr, &endPtr, 0);
-		if(beginPtr == endPtr)
-			break;
-		out.push_back(value);
-		beginPtr = endPtr;
-	}
-	return out;
-}
+using NumberParser::ReadFloatArray;
+using NumberParser::ReadIntArray;
 
 static std::vector<Hash> ReadNameArray(const char* text)
 {
@@ -179,7 +228,7 @@ Matrix4 ColladaFile::Base::GetMatrix4(const char* element) const
 	auto matrix = mXmlNode.child(element);
 	if(!matrix)
 		return Matrix4::Identity();
-	 auto values = ReadFloatArray(matrix.child_value());
+	 auto values = ReadFloatArray(matrix.child_value(), 16);
 	 if(values.size() != 16)
 		 throw std::runtime_error("Invalid number of entries in transform matrix");
 	 return Matrix4(values.data());
@@ -217,7 +266,10 @@ ColladaFile::Skin ColladaFile::Controller::GetSkin() const
 
 ColladaFile::Mesh ColladaFile::Geometry::GetMesh() const
 {
-	return GetChild<Mesh>("mesh");
+	auto mesh = mXmlNode.child("mesh");
+	if(!mesh)
+		throw std::runtime_error("mesh not present");
+	return Mesh(mesh, mMeshChildren);
 }
 
 ColladaFile::Polylist ColladaFile::Mesh::GetPolylist() const
@@ -230,14 +282,29 @@ ColladaFile::Triangles ColladaFile::Mesh::GetTriangles() const
 	return GetChild<Triangles>("triangles");
 }
 
+pugi::xml_node ColladaFile::Mesh::FindChild(const char* element, const char* id) const
+{
+	if(mChildren)
+	{
+		auto it = mChildren->find(id);
+		if(it != mChildren->end() && std::strcmp(it->second.name(), element) == 0)
+			return it->second;
+	}
+	// Not indexed, or id shared by elements of different types:
+	auto node = mXmlNode.find_child_by_attribute(element, "id", id);
+	if(!node)
+		throw std::runtime_error(std::string(element) + " with id \"" + id + "\" not found");
+	return node;
+}
+
 ColladaFile::Source ColladaFile::Mesh::GetSource(const char* id) const
 {
-	return GetChild<Source>("source", id);
+	return Source(FindChild("source", id));
 }
 
 ColladaFile::Vertices ColladaFile::Mesh::GetVertices(const char* id) const
 {
-	return GetChild<Vertices>("vertices", id);
+	return Vertices(FindChild("vertices", id));
 }
 
 ColladaFile::InstanceGeometry ColladaFile::Node::GetInstanceGeometry() const
@@ -250,7 +317,7 @@ std::vector<int> ColladaFile::Polylist::GetVertexCounts() const
 	auto vcount = mXmlNode.child("vcount");
 	if(!vcount)
 		throw std::runtime_error("No vcount in polylist");
-	return ReadIntArray(vcount.child_value());
+	return ReadIntArray(vcount.child_value(), std::max(GetCount(), 0));
 }
 
 std::vector<int> ColladaFile::Polylist::GetPrimitives() const
@@ -289,7 +356,7 @@ std::vector<float> ColladaFile::Source::GetFloatArray(const char* id) const
 	auto floatArray = mXmlNode.find_child_by_attribute("float_array", "id", id);
 	if(!floatArray)
 		throw std::runtime_error(std::string("No float_array ") + id + " in source");
-	return ReadFloatArray(floatArray.child_value());
+	return ReadFloatArray(floatArray.child_value(), floatArray.attribute("count").as_uint());
 }
 
 std::vector<Matrix4> ColladaFile::Source::GetFloatArrayAsMatrices(const char* id) const
@@ -332,7 +399,12 @@ std::vector<int> ColladaFile::Triangles::GetPrimitives() const
 	auto p = mXmlNode.child("p");
 	if(!p)
 		throw std::runtime_error("No p in triangles");
-	return ReadIntArray(p.child_value());
+
+	// One index per input offset for each of the three vertices:
+	int numOffsets = 0;
+	for(auto& input: mXmlNode.children("input"))
+		numOffsets = std::max(numOffsets, input.attribute("offset").as_int() + 1);
+	return ReadIntArray(p.child_value(), std::max(GetCount(), 0) * size_t(3) * numOffsets);
 }
 
 std::vector<int> ColladaFile::VertexWeights::GetVCount() const
@@ -340,7 +412,7 @@ std::vector<int> ColladaFile::VertexWeights::GetVCount() const
 	auto vcount = mXmlNode.child("vcount");
 	if(!vcount)
 		throw std::runtime_error("No vcount in vertex_weights");
-	return ReadIntArray(vcount.child_value());
+	return ReadIntArray(vcount.child_value(), std::max(GetCount(), 0));
 }
 
 std::vector<int> ColladaFile::VertexWeights::GetV() const
@@ -29,8 +29,10 @@ SOFTWARE.
 #include <molecular/util/Matrix4.h>
 #include <molecular/util/Hash.h>
 #include <pugixml.hpp>
-#include <vector>
+#include <cstring>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace molecular
 {
@@ -69,9 +71,20 @@ public:
 	class Vertices;
 	class VisualScene;
 
+	/// Map file copy-on-write and parse it in place
+	/** The file is not read up front and its contents are not copied. Only pages modified by the parser are
+		duplicated in memory. */
 	explicit ColladaFile(const char* filename);
+
+	/// Parse file contents in place
+	/** @param fileContents Modified by the parser and referenced by all elements, so it must outlive this object. */
 	explicit ColladaFile(void* fileContents, size_t size);
 
+	~ColladaFile();
+
+	ColladaFile(const ColladaFile&) = delete;
+	ColladaFile& operator=(const ColladaFile&) = delete;
+
 	Asset GetAsset() const;
 	std::vector<Animation> GetAnimations() const;
 	Scene GetScene() const;
@@ -83,8 +96,50 @@ public:
 	std::vector<Controller> GetControllers() const;
 
 private:
+	/// FNV-1a hash of a zero-terminated string
+	struct IdHash
+	{
+		size_t operator()(const char* id) const
+		{
+			size_t hash = 2166136261u;
+			for(; *id; ++id)
+				hash = (hash ^ static_cast<unsigned char>(*id)) * 16777619u;
+			return hash;
+		}
+	};
+
+	struct IdEqual
+	{
+		bool operator()(const char* a, const char* b) const {return std::strcmp(a, b) == 0;}
+	};
+
+	/// Elements by id attribute, keys point into the document
+	using IdMap = std::unordered_map<const char*, pugi::xml_node, IdHash, IdEqual>;
+
+	/// Geometry element and the elements with ids in its mesh
+	struct GeometryEntry
+	{
+		pugi::xml_node geometry;
+		IdMap meshChildren;
+	};
+
+	void Parse(void* fileContents, size_t size);
+
+	/// Index first child with each id among the children of type element
+	static void IndexChildren(pugi::xml_node parent, const char* element, IdMap& index);
+
+	/// Private mapping of the file, nullptr if contents were passed to the constructor
+	void* mMappedFile = nullptr;
+	size_t mMappedSize = 0;
+
 	pugi::xml_document mDocument;
 	pugi::xml_node mCollada;
+
+	/// Built once after parsing, so that resolving URLs does not scan libraries
+	std::unordered_map<const char*, GeometryEntry, IdHash, IdEqual> mGeometries;
+	IdMap mVisualScenes;
+	IdMap mMaterials;
+	IdMap mControllers;
 };
 
 class ColladaFile::Base
@@ -199,7 +254,9 @@ public:
 	Mesh GetMesh() const;
 
 private:
-	Geometry(pugi::xml_node geometry) : Base(geometry) {}
+	Geometry(pugi::xml_node geometry, const IdMap* meshChildren = nullptr) : Base(geometry), mMeshChildren(meshChildren) {}
+
+	const IdMap* mMeshChildren;
 };
 
 class ColladaFile::Input : ColladaFile::Base
@@ -268,7 +325,13 @@ public:
 	auto GetSources() const {return GetChildren<Source>("source");}
 
 private:
-	Mesh(pugi::xml_node mesh) : Base(mesh) {}
+	Mesh(pugi::xml_node mesh, const IdMap* children = nullptr) : Base(mesh), mChildren(children) {}
+
+	/// Child element of type element with the given id, using the index if available
+	pugi::xml_node FindChild(const char* element, const char* id) const;
+
+	/// Children with id attribute, nullptr if the mesh was not created through ColladaFile::GetGeometry()
+	const IdMap* mChildren;
 };
 
 class ColladaFile::Node : ColladaFile::Base
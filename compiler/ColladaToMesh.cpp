@@ -32,6 +32,12 @@ SOFTWARE.
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
 
 namespace molecular
 {
@@ -289,52 +295,283 @@ Mesh ToMesh(const ColladaFile& file, const ColladaFile::Skin& skin)
 	return outMesh;
 }
 
-MeshSet ToMesh(const ColladaFile& file, const ColladaFile::Node& node)
+/// Called for every node instantiating a geometry or skin controller
+/** @param skinned True for the controller instance of the node, false for its geometry instance.
+	@param nodeMatrices Matrices of the node and all its ancestors, outermost first. */
+using InstanceVisitor = std::function<void(const ColladaFile::Node& node, bool skinned, const std::vector<Matrix4>& nodeMatrices)>;
+
+/// @param nodeMatrices Matrices of all ancestors of node, outermost first.
+static void ForEachInstance(const ColladaFile::Node& node, std::vector<Matrix4>& nodeMatrices, const InstanceVisitor& visitor)
 {
-	MeshSet out;
+	nodeMatrices.push_back(node.GetMatrix());
 	if(node.HasInstanceGeometry())
-	{
-		const char* url = node.GetInstanceGeometry().GetUrl();
-		out.push_back(ToMesh(file, file.GetGeometry(url + 1).GetMesh()));
-	}
+		visitor(node, false, nodeMatrices);
 	if(node.HasInstanceController())
+		visitor(node, true, nodeMatrices);
+	for(auto& n: node.GetNodes())
+		ForEachInstance(n, nodeMatrices, visitor); // Recurse into child nodes
+	nodeMatrices.pop_back();
+}
+
+/// Convert geometry or skin instantiated by a node, without transformation
+static Mesh ToMesh(const ColladaFile& file, const ColladaFile::Node& node, bool skinned)
+{
+	if(skinned)
+		return ToMesh(file, file.GetController(node.GetInstanceController().GetUrl() + 1).GetSkin());
+	else
+		return ToMesh(file, file.GetGeometry(node.GetInstanceGeometry().GetUrl() + 1).GetMesh());
+}
+
+/// Transform mesh to world space
+/** Matrices are applied from innermost to outermost node, in the same order as when transforming whole subtrees. */
+static void Transform(Mesh& mesh, const std::vector<Matrix4>& nodeMatrices)
+{
+	for(auto it = nodeMatrices.rbegin(); it != nodeMatrices.rend(); ++it)
+		MeshUtils::Transform(mesh, *it);
+}
+
+/// Identifies the geometry or controller instantiated by a node
+using InstanceKey = std::pair<bool, std::string>;
+
+static InstanceKey GetInstanceKey(const ColladaFile::Node& node, bool skinned)
+{
+	if(skinned)
+		return InstanceKey(true, node.GetInstanceController().GetUrl());
+	else
+		return InstanceKey(false, node.GetInstanceGeometry().GetUrl());
+}
+
+/// Untransformed meshes of geometries and skins instanced more than once
+/** Each of them is converted only once and kept until its last instance has been requested. */
+class InstanceCache
+{
+public:
+	/// Count one more instance, must be called for all instances before GetMesh()
+	void AddInstance(const ColladaFile::Node& node, bool skinned)
 	{
-		const char* url = node.GetInstanceController().GetUrl();
-		auto controller = file.GetController(url + 1);
-		auto skin = controller.GetSkin();
-		out.push_back(ToMesh(file, skin));
+		mEntries[GetInstanceKey(node, skinned)].remaining++;
 	}
-	for(auto& n: node.GetNodes())
+
+	/// Copy of the untransformed mesh, converted on first request
+	Mesh GetMesh(const ColladaFile& file, const ColladaFile::Node& node, bool skinned)
 	{
-		// Recurse into child nodes
-		auto meshes = ToMesh(file, n);
-		for(auto& mesh: meshes)
-			out.push_back(std::move(mesh));
-//		out.insert(out.end(), std::make_move_iterator(meshes.begin()), std::make_move_iterator(meshes.end()));
+		auto it = mEntries.find(GetInstanceKey(node, skinned));
+		if(it == mEntries.end())
+			return ToMesh(file, node, skinned);
+
+		Entry& entry = it->second;
+		if(!entry.mesh)
+		{
+			if(entry.remaining <= 1)
+			{
+				mEntries.erase(it);
+				return ToMesh(file, node, skinned);
+			}
+			entry.mesh.reset(new Mesh(ToMesh(file, node, skinned)));
+		}
+		if(--entry.remaining == 0)
+		{
+			// Last instance takes the cached mesh:
+			Mesh mesh = std::move(*entry.mesh);
+			mEntries.erase(it);
+			return mesh;
+		}
+		return *entry.mesh;
 	}
-	Matrix4 matrix = node.GetMatrix();
-	for(auto& mesh: out)
-		MeshUtils::Transform(mesh, matrix);
+
+private:
+	struct Entry
+	{
+		unsigned int remaining = 0;
+		std::unique_ptr<Mesh> mesh;
+	};
+
+	std::map<InstanceKey, Entry> mEntries;
+};
+
+/// @param nodeMatrices Matrices of all ancestors of node, outermost first.
+static void ForEachMesh(const ColladaFile& file, const ColladaFile::Node& node, std::vector<Matrix4>& nodeMatrices, InstanceCache& cache, const MeshVisitor& visitor)
+{
+	ForEachInstance(node, nodeMatrices, [&](const ColladaFile::Node& instanceNode, bool skinned, const std::vector<Matrix4>& instanceMatrices)
+	{
+		Mesh mesh = cache.GetMesh(file, instanceNode, skinned);
+		Transform(mesh, instanceMatrices);
+		visitor(mesh);
+	});
+}
+
+/// Prepare cache for all instances below node
+static void CountInstances(const ColladaFile::Node& node, std::vector<Matrix4>& nodeMatrices, InstanceCache& cache)
+{
+	ForEachInstance(node, nodeMatrices, [&cache](const ColladaFile::Node& instanceNode, bool skinned, const std::vector<Matrix4>&)
+	{
+		cache.AddInstance(instanceNode, skinned);
+	});
+}
+
+void ForEachMesh(const ColladaFile& file, const ColladaFile::VisualScene& scene, const MeshVisitor& visitor)
+{
+	std::vector<Matrix4> nodeMatrices;
+	InstanceCache cache;
+	const auto nodes = scene.GetNodes();
+	for(auto& node: nodes)
+		CountInstances(node, nodeMatrices, cache);
+	for(auto& node: nodes)
+		ForEachMesh(file, node, nodeMatrices, cache, visitor);
+}
+
+void ForEachMesh(const ColladaFile& file, const MeshVisitor& visitor)
+{
+	const char* sceneUrl = file.GetScene().GetInstanceVisualSceneUrl();
+	ForEachMesh(file, file.GetVisualScene(sceneUrl + 1), visitor);
+}
+
+MeshSet ToMesh(const ColladaFile& file, const ColladaFile::Node& node)
+{
+	MeshSet out;
+	std::vector<Matrix4> nodeMatrices;
+	InstanceCache cache;
+	CountInstances(node, nodeMatrices, cache);
+	ForEachMesh(file, node, nodeMatrices, cache, [&out](Mesh& mesh){out.push_back(std::move(mesh));});
 	return out;
 }
 
-MeshSet ToMesh(const ColladaFile& file, const ColladaFile::VisualScene& scene)
+/// Call body for indices 0 to count - 1 on multiple threads
+/** Indices are handed out in ascending order. Exceptions are collected per index and the one with the lowest index is
+	rethrown after all threads have finished. */
+static void ParallelFor(size_t count, unsigned int numThreads, const std::function<void(size_t)>& body)
+{
+	std::vector<std::exception_ptr> exceptions(count);
+	std::atomic<size_t> nextIndex(0);
+	numThreads = std::min<size_t>(numThreads, std::max<size_t>(count, 1));
+	std::vector<std::thread> threads;
+	for(unsigned int t = 0; t < numThreads; ++t)
+	{
+		threads.emplace_back([&]()
+		{
+			for(size_t i = nextIndex++; i < count; i = nextIndex++)
+			{
+				try
+				{
+					body(i);
+				}
+				catch(...)
+				{
+					exceptions[i] = std::current_exception();
+				}
+			}
+		});
+	}
+	for(auto& thread: threads)
+		thread.join();
+
+	for(auto& exception: exceptions)
+	{
+		if(exception)
+			std::rethrow_exception(exception);
+	}
+}
+
+/// Node instantiating a geometry or skin, collected for conversion on worker threads
+struct MeshInstance
 {
+	MeshInstance(const ColladaFile::Node& node, bool skinned, const std::vector<Matrix4>& nodeMatrices) :
+		node(node), skinned(skinned), nodeMatrices(nodeMatrices)
+	{}
+
+	ColladaFile::Node node;
+	bool skinned;
+	std::vector<Matrix4> nodeMatrices;
+	/// Index into shared meshes if the geometry is instanced more than once, otherwise -1
+	int shared = -1;
+};
+
+MeshSet ToMesh(const ColladaFile& file, const ColladaFile::VisualScene& scene, unsigned int numThreads)
+{
+	if(numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
 	MeshSet out;
+	if(numThreads == 1)
+	{
+		ForEachMesh(file, scene, [&out](Mesh& mesh){out.push_back(std::move(mesh));});
+		return out;
+	}
+
+	// Traversing the node tree is cheap, so do it first and only convert meshes in parallel:
+	std::vector<MeshInstance> instances;
+	std::vector<Matrix4> nodeMatrices;
 	for(auto& node: scene.GetNodes())
 	{
-		auto meshes = ToMesh(file, node);
-		for(auto& mesh: meshes)
-			out.push_back(std::move(mesh));
-//		out.insert(out.end(), std::make_move_iterator(meshes.begin()), std::make_move_iterator(meshes.end()));
+		ForEachInstance(node, nodeMatrices, [&instances](const ColladaFile::Node& instanceNode, bool skinned, const std::vector<Matrix4>& instanceMatrices)
+		{
+			instances.emplace_back(instanceNode, skinned, instanceMatrices);
+		});
+	}
+
+	// Find geometries instanced more than once, numbered by first instance:
+	std::map<InstanceKey, std::vector<size_t>> instancesByKey;
+	for(size_t i = 0; i < instances.size(); ++i)
+		instancesByKey[GetInstanceKey(instances[i].node, instances[i].skinned)].push_back(i);
+	std::vector<size_t> sharedFirstInstances;
+	for(auto& key: instancesByKey)
+	{
+		if(key.second.size() > 1)
+			sharedFirstInstances.push_back(key.second.front());
+	}
+	std::sort(sharedFirstInstances.begin(), sharedFirstInstances.end());
+	for(size_t s = 0; s < sharedFirstInstances.size(); ++s)
+	{
+		const MeshInstance& first = instances[sharedFirstInstances[s]];
+		for(size_t i: instancesByKey[GetInstanceKey(first.node, first.skinned)])
+			instances[i].shared = s;
 	}
+
+	// Convert shared meshes once. Failures are reported by the instances, so that the error is the same as in the
+	// serial conversion:
+	std::vector<std::unique_ptr<Mesh>> sharedMeshes(sharedFirstInstances.size());
+	std::vector<std::exception_ptr> sharedExceptions(sharedFirstInstances.size());
+	ParallelFor(sharedFirstInstances.size(), numThreads, [&](size_t s)
+	{
+		const MeshInstance& instance = instances[sharedFirstInstances[s]];
+		try
+		{
+			sharedMeshes[s].reset(new Mesh(ToMesh(file, instance.node, instance.skinned)));
+		}
+		catch(...)
+		{
+			sharedExceptions[s] = std::current_exception();
+		}
+	});
+
+	// Each instance is converted into its own slot, so the order of the result does not depend on scheduling.
+	// The document is only read by the threads.
+	std::vector<std::unique_ptr<Mesh>> meshes(instances.size());
+	ParallelFor(instances.size(), numThreads, [&](size_t i)
+	{
+		const MeshInstance& instance = instances[i];
+		if(instance.shared >= 0)
+		{
+			if(sharedExceptions[instance.shared])
+				std::rethrow_exception(sharedExceptions[instance.shared]);
+			meshes[i].reset(new Mesh(*sharedMeshes[instance.shared]));
+		}
+		else
+			meshes[i].reset(new Mesh(ToMesh(file, instance.node, instance.skinned)));
+		Transform(*meshes[i], instance.nodeMatrices);
+	});
+	sharedMeshes.clear();
+
+	out.reserve(meshes.size());
+	for(auto& mesh: meshes)
+		out.push_back(std::move(*mesh));
 	return out;
 }
 
-MeshSet ToMesh(const ColladaFile& file)
+MeshSet ToMesh(const ColladaFile& file, unsigned int numThreads)
 {
 	const char* sceneUrl = file.GetScene().GetInstanceVisualSceneUrl();
-	return ToMesh(file, file.GetVisualScene(sceneUrl + 1));
+	return ToMesh(file, file.GetVisualScene(sceneUrl + 1), numThreads);
 }
 
 void ReadInverseBindMatrices(
@@ -28,6 +28,7 @@ SOFTWARE.
 
 #include "ColladaFile.h"
 #include <molecular/util/Mesh.h>
+#include <functional>
 
 namespace molecular
 {
@@ -43,8 +44,20 @@ using namespace util;
 Mesh ToMesh(const ColladaFile& file, const ColladaFile::Mesh& mesh);
 
 MeshSet ToMesh(const ColladaFile& file, const ColladaFile::Node& node);
-MeshSet ToMesh(const ColladaFile& file, const ColladaFile::VisualScene& scene);
-MeshSet ToMesh(const ColladaFile& file);
+
+/// Convert all meshes of a scene, transformed to world space
+/** @param numThreads Number of worker threads converting geometry instances, 0 for one per hardware thread.
+		Results do not depend on the number of threads. */
+MeshSet ToMesh(const ColladaFile& file, const ColladaFile::VisualScene& scene, unsigned int numThreads = 1);
+MeshSet ToMesh(const ColladaFile& file, unsigned int numThreads = 1);
+
+/// Called once for every mesh in the scene, already transformed to world space
+/** The visitor may move from or modify the mesh. */
+using MeshVisitor = std::function<void(Mesh&)>;
+
+/// Convert meshes of a scene one at a time instead of collecting them in a MeshSet
+void ForEachMesh(const ColladaFile& file, const ColladaFile::VisualScene& scene, const MeshVisitor& visitor);
+void ForEachMesh(const ColladaFile& file, const MeshVisitor& visitor);
 
 /// Returns inverse bind matrices of the first skin controller found in the file
 /** Sorted as in CharacterAnimation.
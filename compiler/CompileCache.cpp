@@ -0,0 +1,231 @@
+/*	CompileCache.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "CompileCache.h"
+#include <molecular/meshfile/MeshFile.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace molecular
+{
+
+/// SHA-256 (FIPS 180-4) of everything passed to Update()
+/** Cached files are served on key equality alone, so the hash has to be collision resistant. */
+class ContentHash
+{
+public:
+	void Update(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		mSize += size;
+		while(size > 0)
+		{
+			const size_t count = std::min(size, sizeof(mBlock) - mBlockSize);
+			std::memcpy(mBlock + mBlockSize, bytes, count);
+			mBlockSize += count;
+			bytes += count;
+			size -= count;
+			if(mBlockSize == sizeof(mBlock))
+			{
+				ProcessBlock();
+				mBlockSize = 0;
+			}
+		}
+	}
+
+	void Update(const std::string& text)
+	{
+		const uint64_t size = text.size();
+		Update(&size, sizeof(size));
+		Update(text.data(), text.size());
+	}
+
+	/// Finish and return digest as hex string, the hash cannot be updated afterwards
+	std::string Finish()
+	{
+		const uint64_t bitSize = mSize * 8;
+		mBlock[mBlockSize++] = 0x80;
+		if(mBlockSize > 56)
+		{
+			std::memset(mBlock + mBlockSize, 0, sizeof(mBlock) - mBlockSize);
+			ProcessBlock();
+			mBlockSize = 0;
+		}
+		std::memset(mBlock + mBlockSize, 0, 56 - mBlockSize);
+		for(int i = 0; i < 8; ++i)
+			mBlock[56 + i] = uint8_t(bitSize >> (56 - 8 * i));
+		ProcessBlock();
+
+		char hex[65];
+		for(int i = 0; i < 8; ++i)
+			std::snprintf(hex + 8 * i, 9, "%08x", static_cast<unsigned int>(mState[i]));
+		return std::string(hex, 64);
+	}
+
+private:
+	static uint32_t Rotate(uint32_t x, int n) {return (x >> n) | (x << (32 - n));}
+
+	void ProcessBlock()
+	{
+		static const uint32_t k[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+		uint32_t w[64];
+		for(int i = 0; i < 16; ++i)
+			w[i] = uint32_t(mBlock[4 * i]) << 24 | uint32_t(mBlock[4 * i + 1]) << 16 | uint32_t(mBlock[4 * i + 2]) << 8 | mBlock[4 * i + 3];
+		for(int i = 16; i < 64; ++i)
+		{
+			const uint32_t s0 = Rotate(w[i - 15], 7) ^ Rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			const uint32_t s1 = Rotate(w[i - 2], 17) ^ Rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		uint32_t a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+		uint32_t e = mState[4], f = mState[5], g = mState[6], h = mState[7];
+		for(int i = 0; i < 64; ++i)
+		{
+			const uint32_t t1 = h + (Rotate(e, 6) ^ Rotate(e, 11) ^ Rotate(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+			const uint32_t t2 = (Rotate(a, 2) ^ Rotate(a, 13) ^ Rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		mState[0] += a; mState[1] += b; mState[2] += c; mState[3] += d;
+		mState[4] += e; mState[5] += f; mState[6] += g; mState[7] += h;
+	}
+
+	uint32_t mState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	uint8_t mBlock[64];
+	size_t mBlockSize = 0;
+	uint64_t mSize = 0;
+};
+
+CompileCache::CompileCache(const std::string& directory) :
+	mDirectory(directory)
+{
+	if(mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST)
+		throw std::runtime_error("Cannot create cache directory " + directory);
+}
+
+std::string CompileCache::GetKey(const std::string& inFileName, const std::string& options) const
+{
+	ContentHash hash;
+	std::ostringstream version;
+	version << "molecularmeshcompiler " << kCompilerVersion << " meshfile " << meshfile::MeshFile::kVersion;
+	hash.Update(version.str());
+	hash.Update(options);
+
+	std::ifstream file(inFileName, std::ios::binary);
+	if(!file)
+		throw std::runtime_error("Cannot open " + inFileName);
+	std::vector<char> chunk(1 << 20);
+	uint64_t fileSize = 0;
+	while(file.read(chunk.data(), chunk.size()) || file.gcount() > 0)
+	{
+		hash.Update(chunk.data(), file.gcount());
+		fileSize += file.gcount();
+	}
+	if(file.bad())
+		throw std::runtime_error("Cannot read " + inFileName);
+	hash.Update(&fileSize, sizeof(fileSize));
+
+	return hash.Finish();
+}
+
+bool CompileCache::Fetch(const std::string& key, const std::string& outFileName) const
+{
+	const std::string entry = GetEntryFileName(key);
+	Unlink(outFileName);
+	if(link(entry.c_str(), outFileName.c_str()) == 0)
+		return true;
+	if(errno == ENOENT)
+		return false;
+
+	// Different file system or no hard link support:
+	return CopyFile(entry, outFileName);
+}
+
+void CompileCache::Store(const std::string& key, const std::string& outFileName) const
+{
+	// Write to a unique temporary file first, renaming is atomic:
+	std::ostringstream tempFileName;
+	tempFileName << GetEntryFileName(key) << ".tmp" << getpid() << "_" << std::this_thread::get_id();
+	if(!CopyFile(outFileName, tempFileName.str()))
+		throw std::runtime_error("Cannot read " + outFileName);
+	chmod(tempFileName.str().c_str(), 0444);
+	if(std::rename(tempFileName.str().c_str(), GetEntryFileName(key).c_str()) != 0)
+	{
+		Unlink(tempFileName.str());
+		throw std::runtime_error("Cannot write cache entry " + GetEntryFileName(key));
+	}
+}
+
+void CompileCache::Unlink(const std::string& fileName)
+{
+	if(unlink(fileName.c_str()) != 0 && errno != ENOENT)
+		throw std::runtime_error("Cannot remove " + fileName);
+}
+
+std::string CompileCache::GetEntryFileName(const std::string& key) const
+{
+	return mDirectory + "/" + key + ".mmf";
+}
+
+bool CompileCache::CopyFile(const std::string& from, const std::string& to)
+{
+	std::ifstream in(from, std::ios::binary);
+	if(!in)
+		return false;
+	std::ofstream out(to, std::ios::binary | std::ios::trunc);
+	out << in.rdbuf();
+	if(!out)
+		throw std::runtime_error("Cannot write " + to);
+	return true;
+}
+
+} // namespace molecular
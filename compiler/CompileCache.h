@@ -0,0 +1,74 @@
+/*	CompileCache.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_COMPILECACHE_H
+#define MOLECULAR_COMPILECACHE_H
+
+#include <cstdint>
+#include <string>
+
+namespace molecular
+{
+
+/// Directory of compiled mesh files keyed by a hash of their input
+/** Entries are named after a hash of the compiler version, the options affecting the output and the contents of the
+	input file. They are made read-only and can therefore be hard linked to outputs. Multiple processes and threads may
+	use the same directory. */
+class CompileCache
+{
+public:
+	/// Increment whenever the compiler produces different output for the same input and options
+	static const unsigned int kCompilerVersion = 2;
+
+	/// Open cache directory, creating it if needed
+	explicit CompileCache(const std::string& directory);
+
+	/// Compute key for an input file
+	/** @param options Canonical description of all options that affect the output. */
+	std::string GetKey(const std::string& inFileName, const std::string& options) const;
+
+	/// Provide cached file as output, either hard linked or copied
+	/** @returns false if there is no entry for the key. */
+	bool Fetch(const std::string& key, const std::string& outFileName) const;
+
+	/// Copy compiled file into the cache
+	void Store(const std::string& key, const std::string& outFileName) const;
+
+	/// Remove file so that writing to its name cannot modify a hard linked cache entry
+	static void Unlink(const std::string& fileName);
+
+private:
+	std::string GetEntryFileName(const std::string& key) const;
+
+	/// Copy file contents
+	/** @returns false if the source cannot be opened. */
+	static bool CopyFile(const std::string& from, const std::string& to);
+
+	std::string mDirectory;
+};
+
+} // namespace molecular
+
+#endif // MOLECULAR_COMPILECACHE_H
@@ -0,0 +1,246 @@
+/*	MeshAnalysis.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeshAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace molecular
+{
+using namespace util;
+
+namespace MeshAnalysis
+{
+
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t numIndices, size_t numVertices,
+		unsigned int cacheSize, CachePolicy policy)
+{
+	VertexCacheStatistics statistics;
+	if(numIndices < 3)
+		return statistics;
+
+	// FIFO: A vertex is in the cache if fewer than cacheSize misses happened since it was loaded.
+	// LRU: A vertex is in the cache if fewer than cacheSize other vertices were used since it was used.
+	std::vector<int64_t> loadedAt(numVertices, -int64_t(cacheSize) - 1);
+	std::vector<uint32_t> lru;
+	std::vector<bool> referenced(numVertices, false);
+	int64_t misses = 0;
+	size_t numReferenced = 0;
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		const uint32_t index = indices[i];
+		if(index >= numVertices)
+			throw std::runtime_error("Index out of range");
+		if(!referenced[index])
+		{
+			referenced[index] = true;
+			numReferenced++;
+		}
+
+		if(policy == CachePolicy::kFifo)
+		{
+			if(misses - loadedAt[index] > cacheSize)
+				loadedAt[index] = misses++;
+		}
+		else
+		{
+			auto it = std::find(lru.begin(), lru.end(), index);
+			if(it == lru.end())
+			{
+				misses++;
+				if(lru.size() >= cacheSize)
+					lru.pop_back();
+			}
+			else
+				lru.erase(it);
+			if(cacheSize > 0)
+				lru.insert(lru.begin(), index);
+		}
+	}
+	statistics.acmr = float(misses) / (numIndices / 3);
+	statistics.atvr = float(misses) / numReferenced;
+	return statistics;
+}
+
+float CalculateAcmr(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned int cacheSize)
+{
+	return AnalyzeVertexCache(indices, numIndices, numVertices, cacheSize, CachePolicy::kFifo).acmr;
+}
+
+float CalculateOverfetch(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned int vertexStride,
+		unsigned int cacheLines)
+{
+	const unsigned int kLineSize = 64;
+	if(vertexStride == 0)
+		return 0.0f;
+	const size_t numLines = (numVertices * vertexStride + kLineSize - 1) / kLineSize;
+	std::vector<int64_t> loadedAt(numLines, -int64_t(cacheLines) - 1);
+	std::vector<bool> referenced(numVertices, false);
+	int64_t misses = 0;
+	size_t numReferenced = 0;
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		const uint32_t index = indices[i];
+		if(index >= numVertices)
+			throw std::runtime_error("Index out of range");
+		if(!referenced[index])
+		{
+			referenced[index] = true;
+			numReferenced++;
+		}
+
+		// A vertex can straddle two lines:
+		const size_t first = size_t(index) * vertexStride / kLineSize;
+		const size_t last = (size_t(index) * vertexStride + vertexStride - 1) / kLineSize;
+		for(size_t line = first; line <= last; ++line)
+		{
+			if(misses - loadedAt[line] > cacheLines)
+				loadedAt[line] = misses++;
+		}
+	}
+	return numReferenced ? float(double(misses) * kLineSize / (double(numReferenced) * vertexStride)) : 0.0f;
+}
+
+/// Depth buffer with counters for one view
+class OverdrawRasterizer
+{
+public:
+	explicit OverdrawRasterizer(unsigned int resolution) :
+		mResolution(resolution),
+		mDepth(size_t(resolution) * resolution, std::numeric_limits<float>::max())
+	{}
+
+	/// Draw triangle with screen coordinates x and y and depth z, smaller z is closer
+	void Draw(const float x[3], const float y[3], const float z[3])
+	{
+		const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if(!(std::abs(area) > 0.0f))
+			return;
+		const float sign = area > 0.0f ? 1.0f : -1.0f;
+
+		const int minX = std::max(0, int(std::floor(std::min({x[0], x[1], x[2]}))));
+		const int maxX = std::min(int(mResolution) - 1, int(std::ceil(std::max({x[0], x[1], x[2]}))));
+		const int minY = std::max(0, int(std::floor(std::min({y[0], y[1], y[2]}))));
+		const int maxY = std::min(int(mResolution) - 1, int(std::ceil(std::max({y[0], y[1], y[2]}))));
+		for(int py = minY; py <= maxY; ++py)
+		{
+			for(int px = minX; px <= maxX; ++px)
+			{
+				// Edge functions at the pixel center, positive inside:
+				const float cx = px + 0.5f, cy = py + 0.5f;
+				const float w0 = sign * ((x[2] - x[1]) * (cy - y[1]) - (y[2] - y[1]) * (cx - x[1]));
+				const float w1 = sign * ((x[0] - x[2]) * (cy - y[2]) - (y[0] - y[2]) * (cx - x[2]));
+				const float w2 = sign * ((x[1] - x[0]) * (cy - y[0]) - (y[1] - y[0]) * (cx - x[0]));
+				if(w0 <= 0.0f || w1 <= 0.0f || w2 <= 0.0f)
+					continue;
+
+				const float depth = (w0 * z[0] + w1 * z[1] + w2 * z[2]) / (w0 + w1 + w2);
+				float& stored = mDepth[size_t(py) * mResolution + px];
+				if(depth < stored)
+				{
+					if(stored == std::numeric_limits<float>::max())
+						mCovered++;
+					stored = depth;
+					mShaded++;
+				}
+			}
+		}
+	}
+
+	uint64_t GetShaded() const {return mShaded;}
+	uint64_t GetCovered() const {return mCovered;}
+
+private:
+	unsigned int mResolution;
+	std::vector<float> mDepth;
+	uint64_t mShaded = 0;
+	uint64_t mCovered = 0;
+};
+
+float EstimateOverdraw(const uint32_t* indices, size_t numIndices, const Vector3* positions, size_t numVertices,
+		unsigned int resolution)
+{
+	if(numIndices < 3 || resolution == 0)
+		return 0.0f;
+
+	float boundsMin[3], boundsMax[3];
+	for(int i = 0; i < 3; ++i)
+	{
+		boundsMin[i] = std::numeric_limits<float>::max();
+		boundsMax[i] = -std::numeric_limits<float>::max();
+	}
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		if(indices[i] >= numVertices)
+			throw std::runtime_error("Index out of range");
+		for(int k = 0; k < 3; ++k)
+		{
+			boundsMin[k] = std::min(boundsMin[k], positions[indices[i]][k]);
+			boundsMax[k] = std::max(boundsMax[k], positions[indices[i]][k]);
+		}
+	}
+	const float extent = std::max({boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]});
+	if(!(extent > 0.0f))
+		return 0.0f;
+	const float scale = resolution / extent;
+
+	uint64_t shaded = 0, covered = 0;
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+		for(float direction: {1.0f, -1.0f})
+		{
+			// Camera on the direction side of the mesh, looking back:
+			OverdrawRasterizer rasterizer(resolution);
+			for(size_t i = 0; i + 2 < numIndices; i += 3)
+			{
+				const Vector3* p[3] = {&positions[indices[i]], &positions[indices[i + 1]], &positions[indices[i + 2]]};
+				const float normal = ((*p[1])[u] - (*p[0])[u]) * ((*p[2])[v] - (*p[0])[v]) - ((*p[2])[u] - (*p[0])[u]) * ((*p[1])[v] - (*p[0])[v]);
+				if(!(normal * direction > 0.0f))
+					continue;
+
+				float x[3], y[3], z[3];
+				for(int k = 0; k < 3; ++k)
+				{
+					x[k] = ((*p[k])[u] - boundsMin[u]) * scale;
+					y[k] = ((*p[k])[v] - boundsMin[v]) * scale;
+					z[k] = -direction * (*p[k])[axis];
+				}
+				rasterizer.Draw(x, y, z);
+			}
+			shaded += rasterizer.GetShaded();
+			covered += rasterizer.GetCovered();
+		}
+	}
+	return covered ? float(double(shaded) / covered) : 0.0f;
+}
+
+}
+
+} // namespace molecular
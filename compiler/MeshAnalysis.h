@@ -0,0 +1,83 @@
+/*	MeshAnalysis.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_MESHANALYSIS_H
+#define MOLECULAR_MESHANALYSIS_H
+
+#include <molecular/util/Vector3.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace molecular
+{
+
+/// Estimates of GPU efficiency of triangle lists
+namespace MeshAnalysis
+{
+
+/// Replacement policy of a simulated post-transform cache
+enum class CachePolicy
+{
+	kFifo, ///< Fixed function hardware, replaces the oldest vertex loaded
+	kLru ///< Replaces the vertex used least recently
+};
+
+/// Result of a post-transform cache simulation
+struct VertexCacheStatistics
+{
+	/// Average cache miss ratio, transforms per triangle
+	/** 3 for no reuse at all, approaches 0.5 for a regular grid. */
+	float acmr = 0.0f;
+
+	/// Average transform to vertex ratio, transforms per referenced vertex
+	/** 1 if every vertex is transformed only once. Unlike ACMR this does not depend on the mesh topology. */
+	float atvr = 0.0f;
+};
+
+/// Simulate a post-transform cache of cacheSize vertices
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t numIndices, size_t numVertices,
+		unsigned int cacheSize = 32, CachePolicy policy = CachePolicy::kFifo);
+
+/// Average number of vertex transforms per triangle with a FIFO post-transform cache
+float CalculateAcmr(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned int cacheSize = 32);
+
+/// Bytes loaded from a vertex buffer divided by the size of the vertices referenced
+/** Simulates a FIFO cache of cacheLines lines of 64 bytes in front of a buffer of vertexStride byte vertices. 1 means
+	every cache line is loaded only once and fully used. */
+float CalculateOverfetch(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned int vertexStride,
+		unsigned int cacheLines = 64);
+
+/// Fragments shaded per covered pixel
+/** Triangles are rasterized in index order with depth test and backface culling (counter-clockwise front faces) into
+	six orthographic views along the positive and negative axes, resolution pixels across the largest extent of the
+	mesh. 1 means that no pixel is shaded twice. */
+float EstimateOverdraw(const uint32_t* indices, size_t numIndices, const util::Vector3* positions, size_t numVertices,
+		unsigned int resolution = 256);
+
+}
+
+} // namespace molecular
+
+#endif // MOLECULAR_MESHANALYSIS_H
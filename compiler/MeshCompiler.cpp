@@ -30,6 +30,13 @@ SOFTWARE.
 #include <molecular/util/Range.h>
 #include <molecular/util/StringUtils.h>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+
 namespace molecular
 {
 using namespace util;
@@ -38,36 +45,62 @@ using namespace meshfile;
 namespace MeshCompiler
 {
 
-void Compile(const std::vector<std::pair<const void*, size_t> >& vertexBuffers,
-		const std::vector<std::pair<const void*, size_t> >& indexBuffers,
-		const std::vector<std::vector<VertexAttributeInfo>>& vertexDataSets,
-		const std::vector<unsigned int>& vertexDataSetVertexCounts,
-		const std::vector<IndexBufferInfo>& indexSpecs,
-		const float boundsMin[3], const float boundsMax[3],
-		WriteStorage& storage
-		)
+/// Write zero bytes after a buffer so that the next one starts 8 byte aligned
+template<class Storage>
+static void WritePadded(Storage& storage, const void* data, size_t size)
 {
-	/* Layout:
-	  Header + Buffer Specs
-	  Index Specs
-	  Vertex Data Sets
-	  Vertex Specs
-	  Buffers */
+	static const uint8_t zero[8] = {0};
+	storage.Write(data, size);
+	unsigned int padding = 8 - (size & 7);
+	storage.Write(zero, padding);
+}
+
+/// Meshlets of each index specification
+using MeshletSets = std::vector<std::vector<MeshFile::Meshlet>>;
 
+/// Header with everything but the specification tables
+static MeshFile MakeHeader(size_t numBuffers, const float boundsMin[3], const float boundsMax[3])
+{
 	MeshFile meshFile;
 	meshFile.magic = MeshFile::kMagic;
 	meshFile.version = MeshFile::kVersion;
-	meshFile.reserved = 0;
-	meshFile.numBuffers = vertexBuffers.size() + indexBuffers.size();
-	meshFile.numIndexSpecs = indexSpecs.size();
-	meshFile.numVertexDataSets = vertexDataSets.size();
-	meshFile.indexSpecsOffset = sizeof(MeshFile) + meshFile.numBuffers * sizeof(MeshFile::Buffer);
-	meshFile.vertexDataSetsOffset = meshFile.indexSpecsOffset + meshFile.numIndexSpecs * sizeof(IndexBufferInfo);
+	meshFile.meshletSetsOffset = 0;
+	meshFile.numBuffers = numBuffers;
 	for(int i = 0; i < 3; ++i)
 	{
 		meshFile.boundsMin[i] = boundsMin[i];
 		meshFile.boundsMax[i] = boundsMax[i];
 	}
+	return meshFile;
+}
+
+/// Set counts and offsets of the specification tables in the header, with the tables starting at tablesOffset
+/** Layout:
+	  Index Specs (full resolution, then levels of detail)
+	  Vertex Data Sets
+	  Vertex Specs
+	  Levels of Detail
+	  Meshlet Sets (optional)
+	  Meshlets (optional)
+	@param lodIndexSpecs Index specifications of the levels of detail, one per level.
+	@param meshletSets Meshlets of each full resolution index specification followed by those of each level of detail,
+		or empty.
+	@returns End of the tables. */
+static uint32_t LayoutTables(uint32_t tablesOffset,
+		const std::vector<std::vector<VertexAttributeInfo>>& vertexDataSets,
+		const std::vector<IndexBufferInfo>& indexSpecs,
+		const std::vector<IndexBufferInfo>& lodIndexSpecs,
+		const MeshletSets& meshletSets,
+		MeshFile& meshFile)
+{
+	if(!meshletSets.empty() && meshletSets.size() != indexSpecs.size() + lodIndexSpecs.size())
+		throw std::logic_error("Number of meshlet sets and index specs not matching");
+
+	meshFile.numIndexSpecs = indexSpecs.size();
+	meshFile.numVertexDataSets = vertexDataSets.size();
+	meshFile.numLods = lodIndexSpecs.size();
+	meshFile.indexSpecsOffset = tablesOffset;
+	meshFile.vertexDataSetsOffset = meshFile.indexSpecsOffset + (indexSpecs.size() + lodIndexSpecs.size()) * sizeof(IndexBufferInfo);
 
 	const uint32_t vertexSpecsOffset = meshFile.vertexDataSetsOffset + vertexDataSets.size() * sizeof(MeshFile::VertexDataSet);
 	unsigned int totalVertexSpecsCount = 0;
@@ -76,53 +109,45 @@ void Compile(const std::vector<std::pair<const void*, size_t> >& vertexBuffers,
 	const uint32_t vertexSpecsSize = totalVertexSpecsCount * sizeof(VertexAttributeInfo);
 
 	uint32_t currentOffset = vertexSpecsOffset + vertexSpecsSize;
-	const uint32_t headersEnd = currentOffset;
-	// Align to 8 bytes
-	currentOffset += 8 - (currentOffset & 7);
-	const uint32_t buffersStart = currentOffset;
-
-	// Write header:
-	storage.Write(&meshFile, sizeof(MeshFile));
-
-	// Write buffer specs:
-	for(auto& indexBuffer: indexBuffers)
+	meshFile.lodsOffset = currentOffset;
+	currentOffset += lodIndexSpecs.size() * sizeof(MeshFile::Lod);
+	meshFile.meshletSetsOffset = 0;
+	if(!meshletSets.empty())
 	{
-		MeshFile::Buffer bufferEntry;
-		bufferEntry.type = MeshFile::Buffer::Type::kIndex;
-		bufferEntry.offset = currentOffset;
-		bufferEntry.size = indexBuffer.second;
-		bufferEntry.reserved = 0;
-		storage.Write(&bufferEntry, sizeof(MeshFile::Buffer));
-		currentOffset += bufferEntry.size;
-
-		// Align to 8 bytes
-		unsigned int padding = 8 - (currentOffset & 7);
-		currentOffset += padding;
+		meshFile.meshletSetsOffset = currentOffset;
+		currentOffset += meshletSets.size() * sizeof(MeshFile::MeshletSet);
+		for(auto& meshlets: meshletSets)
+			currentOffset += meshlets.size() * sizeof(MeshFile::Meshlet);
 	}
+	return currentOffset;
+}
 
-	for(auto& vertexBuffer: vertexBuffers)
-	{
-		MeshFile::Buffer bufferEntry;
-		bufferEntry.type = MeshFile::Buffer::Type::kVertex;
-		bufferEntry.offset = currentOffset;
-		bufferEntry.size = vertexBuffer.second;
-		bufferEntry.reserved = 0;
-		storage.Write(&bufferEntry, sizeof(MeshFile::Buffer));
-		currentOffset += bufferEntry.size;
-
-		// Align to 8 bytes
-		unsigned int padding = 8 - (currentOffset & 7);
-		currentOffset += padding;
-	}
+/// Write specification tables at the offsets set by LayoutTables()
+/** @param numIndexBuffers Number of index buffers, which come before the vertex buffers in the buffer table. */
+template<class Storage>
+static void WriteTables(const MeshFile& meshFile,
+		const std::vector<std::vector<VertexAttributeInfo>>& vertexDataSets,
+		const std::vector<unsigned int>& vertexDataSetVertexCounts,
+		const std::vector<IndexBufferInfo>& indexSpecs,
+		const std::vector<IndexBufferInfo>& lodIndexSpecs,
+		const std::vector<MeshFile::Lod>& lods,
+		const MeshletSets& meshletSets,
+		size_t numIndexBuffers,
+		Storage& storage)
+{
+	if(lodIndexSpecs.size() != lods.size())
+		throw std::logic_error("Number of levels of detail and their index specs not matching");
 
 	// Write index specs:
 	for(auto idxSpec: indexSpecs)
 	{
 		storage.Write(&idxSpec, sizeof(IndexBufferInfo));
 	}
+	for(auto& lodIndexSpec: lodIndexSpecs)
+		storage.Write(&lodIndexSpec, sizeof(IndexBufferInfo));
 
 	// Write vertex data sets
-	uint32_t currentVertexSpecOffset = vertexSpecsOffset;
+	uint32_t currentVertexSpecOffset = meshFile.vertexDataSetsOffset + vertexDataSets.size() * sizeof(MeshFile::VertexDataSet);
 	for(unsigned int i = 0; i < vertexDataSets.size(); ++i)
 	{
 		auto& vertexSpecs = vertexDataSets[i];
@@ -143,37 +168,154 @@ void Compile(const std::vector<std::pair<const void*, size_t> >& vertexBuffers,
 		for(auto vertexSpec: vertexSpecs)
 		{
 			// MeshDataSource counts index and vertex buffers individually from 0:
-			vertexSpec.buffer += indexBuffers.size();
+			vertexSpec.buffer += numIndexBuffers;
 			// Write:
 			storage.Write(&vertexSpec, sizeof(VertexAttributeInfo));
 		}
 	}
 
-	// Write buffers:
-	uint8_t zero[8] = {0};
-	storage.Write(zero, buffersStart - headersEnd);
-	for(auto& indexBuffer: indexBuffers)
+	storage.Write(lods.data(), lods.size() * sizeof(MeshFile::Lod));
+
+	// Write meshlet sets, followed by their meshlets:
+	uint32_t currentMeshletOffset = meshFile.meshletSetsOffset + meshletSets.size() * sizeof(MeshFile::MeshletSet);
+	for(auto& meshlets: meshletSets)
 	{
-		unsigned int size = indexBuffer.second;
-		storage.Write(indexBuffer.first, size);
-		unsigned int padding = 8 - (size & 7);
-		storage.Write(zero, padding);
+		MeshFile::MeshletSet meshletSet;
+		meshletSet.numMeshlets = meshlets.size();
+		meshletSet.meshletsOffset = currentMeshletOffset;
+		meshletSet.maxVertices = 0;
+		meshletSet.maxTriangles = 0;
+		for(auto& meshlet: meshlets)
+		{
+			meshletSet.maxVertices = std::max(meshletSet.maxVertices, meshlet.vertexCount);
+			meshletSet.maxTriangles = std::max(meshletSet.maxTriangles, meshlet.indexCount / 3);
+		}
+		storage.Write(&meshletSet, sizeof(MeshFile::MeshletSet));
+		currentMeshletOffset += meshlets.size() * sizeof(MeshFile::Meshlet);
 	}
+	for(auto& meshlets: meshletSets)
+		storage.Write(meshlets.data(), meshlets.size() * sizeof(MeshFile::Meshlet));
+}
 
-	for(auto& vertexBuffer: vertexBuffers)
+/// Write header, buffer table and specifications, followed by padding up to the first buffer
+/** Buffers follow in the order of the buffer table: index buffers, then vertex buffers.
+	@see LayoutTables() */
+static void WriteHeaders(const std::vector<size_t>& vertexBufferSizes,
+		const std::vector<size_t>& indexBufferSizes,
+		const std::vector<std::vector<VertexAttributeInfo>>& vertexDataSets,
+		const std::vector<unsigned int>& vertexDataSetVertexCounts,
+		const std::vector<IndexBufferInfo>& indexSpecs,
+		const std::vector<IndexBufferInfo>& lodIndexSpecs,
+		const std::vector<MeshFile::Lod>& lods,
+		const MeshletSets& meshletSets,
+		const float boundsMin[3], const float boundsMax[3],
+		WriteStorage& storage
+		)
+{
+	/* Layout:
+	  Header + Buffer Specs
+	  Specification tables
+	  Buffers */
+
+	MeshFile meshFile = MakeHeader(vertexBufferSizes.size() + indexBufferSizes.size(), boundsMin, boundsMax);
+	const uint32_t headersEnd = LayoutTables(sizeof(MeshFile) + meshFile.numBuffers * sizeof(MeshFile::Buffer),
+			vertexDataSets, indexSpecs, lodIndexSpecs, meshletSets, meshFile);
+	// Align to 8 bytes
+	uint32_t currentOffset = headersEnd + 8 - (headersEnd & 7);
+	const uint32_t buffersStart = currentOffset;
+
+	// Write header:
+	storage.Write(&meshFile, sizeof(MeshFile));
+
+	// Write buffer specs:
+	for(size_t indexBufferSize: indexBufferSizes)
+	{
+		MeshFile::Buffer bufferEntry;
+		bufferEntry.type = MeshFile::Buffer::Type::kIndex;
+		bufferEntry.offset = currentOffset;
+		bufferEntry.size = indexBufferSize;
+		bufferEntry.reserved = 0;
+		storage.Write(&bufferEntry, sizeof(MeshFile::Buffer));
+		currentOffset += bufferEntry.size;
+
+		// Align to 8 bytes
+		unsigned int padding = 8 - (currentOffset & 7);
+		currentOffset += padding;
+	}
+
+	for(size_t vertexBufferSize: vertexBufferSizes)
 	{
-		unsigned int size = vertexBuffer.second;
-		storage.Write(vertexBuffer.first, size);
-		unsigned int padding = 8 - (size & 7);
-		storage.Write(zero, padding);
+		MeshFile::Buffer bufferEntry;
+		bufferEntry.type = MeshFile::Buffer::Type::kVertex;
+		bufferEntry.offset = currentOffset;
+		bufferEntry.size = vertexBufferSize;
+		bufferEntry.reserved = 0;
+		storage.Write(&bufferEntry, sizeof(MeshFile::Buffer));
+		currentOffset += bufferEntry.size;
+
+		// Align to 8 bytes
+		unsigned int padding = 8 - (currentOffset & 7);
+		currentOffset += padding;
 	}
 
+	WriteTables(meshFile, vertexDataSets, vertexDataSetVertexCounts, indexSpecs, lodIndexSpecs, lods, meshletSets,
+			indexBufferSizes.size(), storage);
+
+	uint8_t zero[8] = {0};
+	storage.Write(zero, buffersStart - headersEnd);
+}
+
+static std::vector<size_t> GetSizes(const std::vector<std::pair<const void*, size_t>>& buffers)
+{
+	std::vector<size_t> sizes;
+	for(auto& buffer: buffers)
+		sizes.push_back(buffer.second);
+	return sizes;
+}
+
+/// Write buffer contents in the order of the buffer table
+static void WriteBuffers(const std::vector<std::pair<const void*, size_t>>& vertexBuffers,
+		const std::vector<std::pair<const void*, size_t>>& indexBuffers,
+		WriteStorage& storage)
+{
+	for(auto& indexBuffer: indexBuffers)
+		WritePadded(storage, indexBuffer.first, indexBuffer.second);
+
+	for(auto& vertexBuffer: vertexBuffers)
+		WritePadded(storage, vertexBuffer.first, vertexBuffer.second);
+}
+
+void Compile(const std::vector<std::pair<const void*, size_t> >& vertexBuffers,
+		const std::vector<std::pair<const void*, size_t> >& indexBuffers,
+		const std::vector<std::vector<VertexAttributeInfo>>& vertexDataSets,
+		const std::vector<unsigned int>& vertexDataSetVertexCounts,
+		const std::vector<IndexBufferInfo>& indexSpecs,
+		const float boundsMin[3], const float boundsMax[3],
+		WriteStorage& storage
+		)
+{
+	WriteHeaders(GetSizes(vertexBuffers), GetSizes(indexBuffers),
+			vertexDataSets,
+			vertexDataSetVertexCounts,
+			indexSpecs,
+			std::vector<IndexBufferInfo>(),
+			std::vector<MeshFile::Lod>(),
+			MeshletSets(),
+			boundsMin, boundsMax,
+			storage);
+	WriteBuffers(vertexBuffers, indexBuffers, storage);
 }
 
 MeshSet ObjFileToMeshSet(ObjFile& objFile)
 {
-	auto& vertexGroups = objFile.GetVertexGroups();
 	MeshSet meshSet;
+	ForEachMesh(objFile, [&meshSet](Mesh& mesh){meshSet.push_back(std::move(mesh));});
+	return meshSet;
+}
+
+void ForEachMesh(ObjFile& objFile, const MeshVisitor& visitor)
+{
+	auto& vertexGroups = objFile.GetVertexGroups();
 
 	for(auto& vg: vertexGroups)
 	{
@@ -190,8 +332,7 @@ MeshSet ObjFileToMeshSet(ObjFile& objFile)
 		assert(normals.empty() || normals.size() == numVertices);
 		assert(uvs.empty() || uvs.size() == numVertices);
 
-		meshSet.emplace_back(numVertices);
-		Mesh& mesh = meshSet.back();
+		Mesh mesh(numVertices);
 		mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
 		if(!normals.empty())
 			mesh.SetAttributeData(VertexAttributeInfo::kNormal, normals.data(), normals.size());
@@ -204,67 +345,448 @@ MeshSet ObjFileToMeshSet(ObjFile& objFile)
 		outIndices.reserve(indices.size());
 		for(uint32_t index: indices)
 			outIndices.push_back(index);
+
+		visitor(mesh);
 	}
+}
 
-	return meshSet;
+/// Smallest index type that can address all vertices referenced by indices
+static IndexBufferInfo::Type SmallestIndexType(const std::vector<uint32_t>& indices)
+{
+	uint32_t maxIndex = 0;
+	for(uint32_t index: indices)
+		maxIndex = std::max(maxIndex, index);
+
+	if(maxIndex <= std::numeric_limits<uint8_t>::max())
+		return IndexBufferInfo::Type::kUInt8;
+	else if(maxIndex <= std::numeric_limits<uint16_t>::max())
+		return IndexBufferInfo::Type::kUInt16;
+	else
+		return IndexBufferInfo::Type::kUInt32;
+}
+
+/// Append 32 bit indices to a buffer of a possibly smaller index type
+template<typename T>
+static void AppendIndices(const std::vector<uint32_t>& indices, std::vector<uint8_t>& outBuffer)
+{
+	const size_t start = outBuffer.size();
+	outBuffer.resize(start + indices.size() * sizeof(T));
+	T* out = reinterpret_cast<T*>(outBuffer.data() + start);
+	for(size_t i = 0; i < indices.size(); ++i)
+		out[i] = static_cast<T>(indices[i]);
+}
+
+static void AppendIndices(IndexBufferInfo::Type type, const std::vector<uint32_t>& indices, std::vector<uint8_t>& outBuffer)
+{
+	if(type == IndexBufferInfo::Type::kUInt8)
+		AppendIndices<uint8_t>(indices, outBuffer);
+	else if(type == IndexBufferInfo::Type::kUInt16)
+		AppendIndices<uint16_t>(indices, outBuffer);
+	else
+		AppendIndices<uint32_t>(indices, outBuffer);
+}
+
+/// Interleave attributes of a mesh into one vertex buffer
+/** Attributes are aligned to 4 bytes inside each vertex, as some graphics APIs
+	require. */
+static void InterleaveAttributes(const Mesh& mesh,
+		const std::vector<Hash>& semantics,
+		uint32_t buffer,
+		std::vector<uint8_t>& outBuffer,
+		std::vector<VertexAttributeInfo>& outVertexSpecs)
+{
+	const size_t numVertices = mesh.GetNumVertices();
+	std::vector<size_t> elementSizes;
+	uint32_t stride = 0;
+	for(Hash semantic: semantics)
+	{
+		auto& attribute = mesh.GetAttribute(semantic);
+		const size_t elementSize = numVertices ? attribute.GetRawSize() / numVertices : 0;
+		elementSizes.push_back(elementSize);
+
+		VertexAttributeInfo vertexSpec;
+		vertexSpec.buffer = buffer;
+		vertexSpec.components = attribute.GetNumComponents();
+		vertexSpec.normalized = true;
+		vertexSpec.offset = stride;
+		vertexSpec.semantic = semantic;
+		vertexSpec.type = attribute.GetType();
+		outVertexSpecs.push_back(vertexSpec);
+
+		stride += (elementSize + 3) & ~size_t(3);
+	}
+
+	const size_t firstSpec = outVertexSpecs.size() - semantics.size();
+	for(size_t i = firstSpec; i < outVertexSpecs.size(); ++i)
+		outVertexSpecs[i].stride = stride;
+
+	outBuffer.assign(numVertices * stride, 0);
+	for(size_t a = 0; a < semantics.size(); ++a)
+	{
+		const uint8_t* source = static_cast<const uint8_t*>(mesh.GetAttribute(semantics[a]).GetRawData());
+		const size_t elementSize = elementSizes[a];
+		uint8_t* destination = outBuffer.data() + outVertexSpecs[firstSpec + a].offset;
+		for(size_t v = 0; v < numVertices; ++v)
+			memcpy(destination + v * stride, source + v * elementSize, elementSize);
+	}
+}
+
+PassLayout DefaultPassLayout()
+{
+	return {
+		{VertexAttributeInfo::kPosition, VertexAttributeInfo::kSkinWeights, "vertexSkinJointsAttr"_H},
+		{VertexAttributeInfo::kNormal, VertexAttributeInfo::kTextureCoords, VertexAttributeInfo::kVertexPrt0, VertexAttributeInfo::kVertexPrt1, VertexAttributeInfo::kVertexPrt2}
+	};
+}
+
+PassLayout ParsePassLayout(const std::string& description)
+{
+	PassLayout passes(1);
+	const char* begin = description.c_str();
+	while(true)
+	{
+		while(isspace(*begin))
+			begin++;
+		const char* end = begin;
+		while(*end != '\0' && *end != ',' && *end != ';' && !isspace(*end))
+			end++;
+		if(end != begin)
+			passes.back().push_back(HashUtils::MakeHash(begin, end));
+		while(isspace(*end))
+			end++;
+
+		if(*end == '\0')
+			break;
+		else if(*end == ';')
+			passes.emplace_back();
+		else if(*end != ',')
+			throw std::runtime_error("Invalid pass layout \"" + description + "\"");
+		begin = end + 1;
+	}
+	return passes;
+}
+
+/// Buffers and specifications of one mesh
+struct ConvertedMesh
+{
+	IndexBufferInfo indexSpec;
+	/// Levels of detail, with ranges of the same index buffer
+	std::vector<IndexBufferInfo> lodIndexSpecs;
+	/// Indices of all levels in the index type, empty if the indices of the mesh are stored as they are
+	std::vector<uint8_t> convertedIndices;
+	std::vector<std::vector<uint8_t>> vertexBuffers;
+	std::vector<VertexAttributeInfo> vertexSpecs;
+
+	std::pair<const void*, size_t> GetIndexBuffer(const Mesh& mesh) const
+	{
+		if(convertedIndices.empty())
+			return std::make_pair(mesh.GetIndices().data(), mesh.GetIndices().size() * sizeof(uint32_t));
+		else
+			return std::make_pair(convertedIndices.data(), convertedIndices.size());
+	}
+};
+
+/// Narrow indices and interleave vertex attributes of a mesh
+/** Indices of the levels of detail are appended to the index buffer of the mesh.
+	@param indexBuffer Index of the index buffer of this mesh.
+	@param firstVertexBuffer Index of the first vertex buffer of this mesh.
+	@param vertexDataSet Index of the vertex data set of this mesh. */
+static void ConvertMesh(const Mesh& mesh, const std::vector<LevelOfDetail>& lods, const PassLayout& passes,
+		uint32_t indexBuffer, uint32_t firstVertexBuffer, uint32_t vertexDataSet,
+		ConvertedMesh& out, AxisAlignedBox& bounds)
+{
+	// Simplified levels only reference vertices of the mesh, so they fit the same index type:
+	auto& indices = mesh.GetIndices();
+	IndexBufferInfo& indexSpec = out.indexSpec;
+	indexSpec.buffer = indexBuffer;
+	indexSpec.count = indices.size();
+	StringUtils::Copy(mesh.GetMaterial(), indexSpec.material);
+	indexSpec.mode = mesh.GetMode();
+	indexSpec.offset = 0;
+	indexSpec.type = SmallestIndexType(indices);
+	indexSpec.vertexDataSet = vertexDataSet;
+	if(indexSpec.type != IndexBufferInfo::Type::kUInt32 || !lods.empty())
+		AppendIndices(indexSpec.type, indices, out.convertedIndices);
+
+	for(auto& lod: lods)
+	{
+		IndexBufferInfo lodIndexSpec = indexSpec;
+		lodIndexSpec.offset = out.convertedIndices.size();
+		lodIndexSpec.count = lod.indices.size();
+		AppendIndices(indexSpec.type, lod.indices, out.convertedIndices);
+		out.lodIndexSpecs.push_back(lodIndexSpec);
+	}
+
+	// Distribute attributes of this mesh to passes:
+	auto& attributes = mesh.GetAttributes();
+	std::vector<std::vector<Hash>> bufferSemantics(passes.size() + 1);
+	std::unordered_set<Hash> assigned;
+	for(size_t p = 0; p < passes.size(); ++p)
+	{
+		for(Hash semantic: passes[p])
+		{
+			if(attributes.count(semantic) && assigned.insert(semantic).second)
+				bufferSemantics[p].push_back(semantic);
+		}
+	}
+	for(auto& attribute: attributes)
+	{
+		if(!assigned.count(attribute.first))
+			bufferSemantics.back().push_back(attribute.first);
+	}
+	std::sort(bufferSemantics.back().begin(), bufferSemantics.back().end());
+
+	for(auto& semantics: bufferSemantics)
+	{
+		if(semantics.empty())
+			continue;
+		const uint32_t buffer = firstVertexBuffer + out.vertexBuffers.size();
+		out.vertexBuffers.emplace_back();
+		InterleaveAttributes(mesh, semantics, buffer, out.vertexBuffers.back(), out.vertexSpecs);
+	}
+
+	if(attributes.count(VertexAttributeInfo::kPosition))
+	{
+		const Vector3* positions = mesh.GetAttribute(VertexAttributeInfo::kPosition).GetData<Vector3>();
+		for(size_t i = 0; i < mesh.GetNumVertices(); ++i)
+			bounds.Stretch(positions[i]);
+	}
 }
 
-void Compile(const MeshSet& meshes, WriteStorage& storage)
+void Compile(const MeshSet& meshes, WriteStorage& storage, const PassLayout& passes,
+		const std::vector<MeshExtras>& extras)
 {
+	if(!extras.empty() && extras.size() != meshes.size())
+		throw std::logic_error("Number of mesh extras and meshes not matching");
+
+	static const MeshExtras noExtras;
+	std::vector<ConvertedMesh> convertedMeshes(meshes.size());
 	std::vector<std::pair<const void*, size_t>> indexBuffers;
 	std::vector<std::pair<const void*, size_t>> vertexBuffers;
 	std::vector<std::vector<VertexAttributeInfo>> vertexDataSets;
 	std::vector<unsigned int> vertexDataSetVertexCounts;
 	std::vector<IndexBufferInfo> indexSpecs;
+	std::vector<IndexBufferInfo> lodIndexSpecs;
+	std::vector<MeshFile::Lod> lods;
+	MeshletSets meshletSets, lodMeshletSets;
+	bool hasMeshlets = false;
 	util::AxisAlignedBox bounds;
 
-	for(auto& mesh: meshes)
+	for(size_t i = 0; i < meshes.size(); ++i)
 	{
-		auto& indices = mesh.GetIndices();
-		IndexBufferInfo indexSpec;
-		indexSpec.buffer = indexBuffers.size();
-		indexSpec.count = indices.size();
-		StringUtils::Copy(mesh.GetMaterial(), indexSpec.material);
-		indexSpec.mode = mesh.GetMode();
-		indexSpec.offset = 0;
-		indexSpec.type = IndexBufferInfo::Type::kUInt32;
-		indexSpec.vertexDataSet = vertexDataSets.size();
-		indexBuffers.emplace_back(indices.data(), indices.size() * sizeof(uint32_t)); // TODO: Use smaller index types when possible
-		indexSpecs.push_back(indexSpec);
-
-		std::vector<VertexAttributeInfo> vertexSpecs;
-		auto& attributes = mesh.GetAttributes();
-		for(auto& attribute: attributes)
+		const Mesh& mesh = meshes[i];
+		const MeshExtras& meshExtras = extras.empty() ? noExtras : extras[i];
+		ConvertedMesh& converted = convertedMeshes[i];
+		ConvertMesh(mesh, meshExtras.lods, passes, indexBuffers.size(), vertexBuffers.size(), vertexDataSets.size(), converted, bounds);
+
+		indexBuffers.push_back(converted.GetIndexBuffer(mesh));
+		for(auto& vertexBuffer: converted.vertexBuffers)
+			vertexBuffers.emplace_back(vertexBuffer.data(), vertexBuffer.size());
+		meshletSets.push_back(meshExtras.meshlets);
+		hasMeshlets = hasMeshlets || !meshExtras.meshlets.empty();
+		for(size_t level = 0; level < meshExtras.lods.size(); ++level)
 		{
-			VertexAttributeInfo vertexSpec;
-			vertexSpec.buffer = vertexBuffers.size();
-			vertexSpec.components = attribute.second.GetNumComponents();
-			vertexSpec.normalized = true;
-			vertexSpec.offset = 0;
-			vertexSpec.semantic = attribute.first;
-			vertexSpec.stride = 0;
-			vertexSpec.type = attribute.second.GetType();
-			vertexSpecs.push_back(vertexSpec);
-			vertexBuffers.emplace_back(attribute.second.GetRawData(), attribute.second.GetRawSize());
-
-			if(attribute.first == VertexAttributeInfo::kPosition)
-			{
-				const Vector3* positions = attribute.second.GetData<Vector3>();
-				for(size_t i = 0; i < mesh.GetNumVertices(); ++i)
-					bounds.Stretch(positions[i]);
-			}
+			const LevelOfDetail& lod = meshExtras.lods[level];
+			lods.push_back({uint32_t(indexSpecs.size()), uint32_t(level + 1), lod.error, 0});
+			lodIndexSpecs.push_back(converted.lodIndexSpecs[level]);
+			lodMeshletSets.push_back(lod.meshlets);
+			hasMeshlets = hasMeshlets || !lod.meshlets.empty();
 		}
-		vertexDataSets.push_back(vertexSpecs);
+		indexSpecs.push_back(converted.indexSpec);
+		vertexDataSets.push_back(converted.vertexSpecs);
 		vertexDataSetVertexCounts.push_back(mesh.GetNumVertices());
 	}
 
+	if(hasMeshlets)
+		meshletSets.insert(meshletSets.end(), lodMeshletSets.begin(), lodMeshletSets.end());
+	else
+		meshletSets.clear();
 
-	Compile(vertexBuffers, indexBuffers,
+	WriteHeaders(GetSizes(vertexBuffers), GetSizes(indexBuffers),
 			vertexDataSets,
 			vertexDataSetVertexCounts,
 			indexSpecs,
+			lodIndexSpecs,
+			lods,
+			meshletSets,
 			bounds.GetMin(), bounds.GetMax(),
 			storage);
+	WriteBuffers(vertexBuffers, indexBuffers, storage);
+}
+
+/// Start of the first buffer after the header and a buffer table with room for numBuffers entries
+static uint64_t GetBuffersStart(size_t numBuffers)
+{
+	return (sizeof(MeshFile) + numBuffers * sizeof(MeshFile::Buffer) + 7) & ~uint64_t(7);
+}
+
+/// Offset in a mesh file, which has 32 bit offsets
+static uint32_t ToFileOffset(uint64_t offset)
+{
+	if(offset > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("Mesh file larger than 4 GiB");
+	return uint32_t(offset);
+}
+
+/// Output file written front to back, except for the header that is written last
+class StreamingCompiler::OutputFile
+{
+public:
+	explicit OutputFile(const std::string& fileName) :
+		mFileName(fileName),
+		mFile(fileName, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc)
+	{
+		if(!mFile)
+			throw std::runtime_error("Cannot open " + fileName + " for writing");
+	}
+
+	void Write(const void* data, size_t size)
+	{
+		if(!mFile.write(static_cast<const char*>(data), size))
+			throw std::runtime_error("Cannot write " + mFileName);
+	}
+
+	void Read(void* data, size_t size)
+	{
+		if(!mFile.read(static_cast<char*>(data), size))
+			throw std::runtime_error("Cannot read back " + mFileName);
+	}
+
+	void Seek(uint64_t position)
+	{
+		mFile.seekp(position);
+		mFile.seekg(position);
+		if(!mFile)
+			throw std::runtime_error("Cannot seek in " + mFileName);
+	}
+
+	uint64_t GetPosition()
+	{
+		return uint64_t(mFile.tellp());
+	}
+
+	void WriteZeros(uint64_t size)
+	{
+		static const uint8_t zero[4096] = {0};
+		while(size > 0)
+		{
+			const size_t chunkSize = std::min<uint64_t>(size, sizeof(zero));
+			Write(zero, chunkSize);
+			size -= chunkSize;
+		}
+	}
+
+	void Close()
+	{
+		mFile.close();
+		if(!mFile)
+			throw std::runtime_error("Cannot write " + mFileName);
+	}
+
+private:
+	std::string mFileName;
+	std::fstream mFile;
+};
+
+StreamingCompiler::StreamingCompiler(const std::string& fileName, const PassLayout& passes, size_t reservedBuffers) :
+	mPasses(passes),
+	mFile(new OutputFile(fileName)),
+	mReservedBuffers(reservedBuffers)
+{
+	// Header and buffer table are written by Finish():
+	mFile->WriteZeros(GetBuffersStart(mReservedBuffers));
+}
+
+StreamingCompiler::~StreamingCompiler() = default;
+
+void StreamingCompiler::Add(const Mesh& mesh, const MeshExtras& extras)
+{
+	ConvertedMesh converted;
+	ConvertMesh(mesh, extras.lods, mPasses, mIndexBuffers.size(), mVertexBuffers.size(), mVertexDataSets.size(), converted, mBounds);
+
+	// Buffers go to the file as they come, the buffer table records where:
+	auto indexBuffer = converted.GetIndexBuffer(mesh);
+	mIndexBuffers.push_back({MeshFile::Buffer::Type::kIndex, ToFileOffset(mFile->GetPosition()), ToFileOffset(indexBuffer.second), 0});
+	WritePadded(*mFile, indexBuffer.first, indexBuffer.second);
+
+	for(auto& vertexBuffer: converted.vertexBuffers)
+	{
+		mVertexBuffers.push_back({MeshFile::Buffer::Type::kVertex, ToFileOffset(mFile->GetPosition()), ToFileOffset(vertexBuffer.size()), 0});
+		WritePadded(*mFile, vertexBuffer.data(), vertexBuffer.size());
+	}
+
+	mMeshletSets.push_back(extras.meshlets);
+	mHasMeshlets = mHasMeshlets || !extras.meshlets.empty();
+	for(size_t level = 0; level < extras.lods.size(); ++level)
+	{
+		const LevelOfDetail& lod = extras.lods[level];
+		mLods.push_back({uint32_t(mIndexSpecs.size()), uint32_t(level + 1), lod.error, 0});
+		mLodIndexSpecs.push_back(converted.lodIndexSpecs[level]);
+		mLodMeshletSets.push_back(lod.meshlets);
+		mHasMeshlets = mHasMeshlets || !lod.meshlets.empty();
+	}
+	mIndexSpecs.push_back(converted.indexSpec);
+	mVertexDataSets.push_back(std::move(converted.vertexSpecs));
+	mVertexDataSetVertexCounts.push_back(mesh.GetNumVertices());
+}
+
+void StreamingCompiler::MoveBuffers(uint64_t newStart)
+{
+	const uint64_t oldStart = GetBuffersStart(mReservedBuffers);
+	const uint64_t end = mFile->GetPosition();
+	const uint64_t distance = newStart - oldStart;
+
+	// Back to front, so that no chunk overwrites data not yet moved:
+	std::vector<uint8_t> chunk(1 << 20);
+	uint64_t position = end;
+	while(position > oldStart)
+	{
+		const size_t chunkSize = std::min<uint64_t>(position - oldStart, chunk.size());
+		position -= chunkSize;
+		mFile->Seek(position);
+		mFile->Read(chunk.data(), chunkSize);
+		mFile->Seek(position + distance);
+		mFile->Write(chunk.data(), chunkSize);
+	}
+
+	for(auto& buffer: mIndexBuffers)
+		buffer.offset = ToFileOffset(buffer.offset + distance);
+	for(auto& buffer: mVertexBuffers)
+		buffer.offset = ToFileOffset(buffer.offset + distance);
+
+	// Clear the start of the old buffers, where the buffer table does not cover it:
+	mFile->Seek(oldStart);
+	mFile->WriteZeros(distance);
+	mFile->Seek(end + distance);
+}
+
+void StreamingCompiler::Finish()
+{
+	const size_t numBuffers = mIndexBuffers.size() + mVertexBuffers.size();
+	if(numBuffers > mReservedBuffers)
+		MoveBuffers(GetBuffersStart(numBuffers));
+
+	MeshletSets meshletSets;
+	if(mHasMeshlets)
+	{
+		meshletSets = mMeshletSets;
+		meshletSets.insert(meshletSets.end(), mLodMeshletSets.begin(), mLodMeshletSets.end());
+	}
+
+	// Specification tables after the last buffer:
+	MeshFile meshFile = MakeHeader(numBuffers, mBounds.GetMin(), mBounds.GetMax());
+	LayoutTables(ToFileOffset(mFile->GetPosition()), mVertexDataSets, mIndexSpecs, mLodIndexSpecs, meshletSets, meshFile);
+	WriteTables(meshFile, mVertexDataSets, mVertexDataSetVertexCounts, mIndexSpecs, mLodIndexSpecs, mLods, meshletSets,
+			mIndexBuffers.size(), *mFile);
+	// All table offsets are valid if the file end is:
+	ToFileOffset(mFile->GetPosition());
+
+	// Header and buffer table in the space reserved in front of the buffers:
+	mFile->Seek(0);
+	mFile->Write(&meshFile, sizeof(MeshFile));
+	mFile->Write(mIndexBuffers.data(), mIndexBuffers.size() * sizeof(MeshFile::Buffer));
+	mFile->Write(mVertexBuffers.data(), mVertexBuffers.size() * sizeof(MeshFile::Buffer));
+	mFile->Close();
 }
 
 } // namespace
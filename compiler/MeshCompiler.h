@@ -27,10 +27,14 @@ SOFTWARE.
 #define MOLECULAR_MESHCOMPILER_H
 
 #include <molecular/meshfile/MeshFile.h>
+#include <molecular/util/AxisAlignedBox.h>
 #include <molecular/util/BufferInfo.h>
 #include <molecular/util/Mesh.h>
 #include <molecular/util/ObjFile.h>
 #include <molecular/util/StreamStorage.h>
+#include <functional>
+#include <memory>
+#include <string>
 
 namespace molecular
 {
@@ -50,10 +54,95 @@ void Compile(
 		util::WriteStorage& storage
 		);
 
+/// Called once for every mesh produced by a converter
+/** The visitor may move from or modify the mesh. */
+using MeshVisitor = std::function<void(util::Mesh&)>;
+
 util::MeshSet ObjFileToMeshSet(util::ObjFile& objFile);
 
-/** @todo Optimize vertex buffer layout. */
-void Compile(const util::MeshSet& meshes, util::WriteStorage& storage);
+/// Convert vertex groups of an OBJ file one at a time
+void ForEachMesh(util::ObjFile& objFile, const MeshVisitor& visitor);
+
+/// Vertex attribute semantics read by each render pass
+/** Attributes of one pass are interleaved into a common vertex buffer. An
+	attribute listed in multiple passes is stored with the first pass listing
+	it. Attributes not listed at all are interleaved into an additional buffer. */
+using PassLayout = std::vector<std::vector<util::Hash>>;
+
+/// Shadow pass with position and skinning data, main pass with the rest
+PassLayout DefaultPassLayout();
+
+/// Parse pass layout from a string
+/** Passes are separated by semicolons, attribute names within a pass by
+	commas. Example: "vertexPositionAttr;vertexNormalAttr,vertexUv0Attr" */
+PassLayout ParsePassLayout(const std::string& description);
+
+/// Simplified triangles of a mesh, drawn with the vertices of the full resolution mesh
+struct LevelOfDetail
+{
+	std::vector<uint32_t> indices;
+	float error = 0.0f; ///< @see meshfile::MeshFile::Lod::error
+	std::vector<meshfile::MeshFile::Meshlet> meshlets; ///< Meshlets of the simplified triangles
+};
+
+/// Data written along with the buffers of a mesh
+struct MeshExtras
+{
+	std::vector<meshfile::MeshFile::Meshlet> meshlets; ///< Meshlets of the full resolution triangles
+	std::vector<LevelOfDetail> lods; ///< Simplified levels, from most to least detailed
+};
+
+/// Write mesh file with vertex buffers interleaved by render pass
+/** @param extras Meshlets and levels of detail of each mesh, or empty if there are none. The file has meshlets if any
+		mesh or level has them. */
+void Compile(const util::MeshSet& meshes, util::WriteStorage& storage, const PassLayout& passes = DefaultPassLayout(),
+		const std::vector<MeshExtras>& extras = std::vector<MeshExtras>());
+
+/// Write mesh file from meshes added one at a time
+/** Only keeps the buffers of the mesh currently added in memory. Buffers are written to the file as meshes are added,
+	in the order they are added. The specification tables follow the last buffer, and the header and buffer table are
+	written last, into space reserved at the start of the file. The result is equivalent to the output of
+	Compile(const util::MeshSet&, util::WriteStorage&, const PassLayout&, const std::vector<MeshExtras>&), but laid out
+	differently. */
+class StreamingCompiler
+{
+public:
+	/// Create output file
+	/** @param reservedBuffers Number of buffer table entries reserved in front of the buffers. If more buffers are
+			added, Finish() moves all buffers to make room. Meshes have one index buffer and one vertex buffer per
+			pass. */
+	explicit StreamingCompiler(const std::string& fileName, const PassLayout& passes = DefaultPassLayout(),
+			size_t reservedBuffers = 256);
+	~StreamingCompiler();
+
+	/// Convert mesh and write its buffers
+	/** @param extras Meshlets and levels of detail of the mesh. The file has meshlets if any mesh added has them. */
+	void Add(const util::Mesh& mesh, const MeshExtras& extras = MeshExtras());
+
+	/// Write specifications, header and buffer table, and close the file
+	void Finish();
+
+private:
+	class OutputFile;
+
+	/// Move buffers written so far to start at newStart, for a larger buffer table
+	void MoveBuffers(uint64_t newStart);
+
+	PassLayout mPasses;
+	std::unique_ptr<OutputFile> mFile;
+	size_t mReservedBuffers;
+	std::vector<meshfile::MeshFile::Buffer> mIndexBuffers;
+	std::vector<meshfile::MeshFile::Buffer> mVertexBuffers;
+	std::vector<std::vector<util::VertexAttributeInfo>> mVertexDataSets;
+	std::vector<unsigned int> mVertexDataSetVertexCounts;
+	std::vector<util::IndexBufferInfo> mIndexSpecs;
+	std::vector<util::IndexBufferInfo> mLodIndexSpecs;
+	std::vector<meshfile::MeshFile::Lod> mLods;
+	std::vector<std::vector<meshfile::MeshFile::Meshlet>> mMeshletSets;
+	std::vector<std::vector<meshfile::MeshFile::Meshlet>> mLodMeshletSets;
+	bool mHasMeshlets = false;
+	util::AxisAlignedBox mBounds;
+};
 
 }
 
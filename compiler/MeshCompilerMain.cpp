@@ -23,8 +23,15 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "CompileCache.h"
+#include "MeshAnalysis.h"
 #include "MeshCompiler.h"
+#include "Meshlets.h"
+#include "OverdrawOptimizer.h"
+#include "PipelineStats.h"
 #include "PrecomputedRadianceTransfer.h"
+#include "Simplifier.h"
+#include "VertexFetchOptimizer.h"
 #include <molecular/util/MeshUtils.h>
 #include "ColladaFile.h"
 #include "ColladaToMesh.h"
@@ -34,94 +41,700 @@ SOFTWARE.
 #include <molecular/util/FileStreamStorage.h>
 #include <molecular/util/StringUtils.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace molecular;
 using namespace molecular::util;
 using namespace molecular::meshfile;
 
-int main(int argc, char** argv)
+/// Settings for compiling one file
+/** Taken from the command line, batch manifest entries can override them. */
+struct CompileOptions
 {
-	CommandLineParser cmd;
-	CommandLineParser::PositionalArg<std::string> inFileName(cmd, "input file", "Input mesh to compile");
-	CommandLineParser::PositionalArg<std::string> outFileName(cmd, "output file", "Output compiled mesh file");
-	CommandLineParser::Flag prt(cmd, "prt", "Enable radiance transfer precomputation");
-	CommandLineParser::Flag noHalfFloatNormals(cmd, "no-half-float-normals", "Store normals as 32 bit floats instead of 16 bit");
-	CommandLineParser::Flag noTextureCoords(cmd, "no-texture-coords", "Don't store texture coordinates");
-	CommandLineParser::Option<float> scale(cmd, "scale", "Mesh scale factor", 1.0);
-	CommandLineParser::Option<std::string> material(cmd, "material", "Override material string (of all submeshes)");
-	CommandLineParser::HelpFlag help(cmd);
+	bool prt = false;
+	bool noHalfFloatNormals = false;
+	bool noTextureCoords = false;
+	bool stream = false;
+	bool meshlets = false;
+	unsigned int lods = 0;
+	float overdrawThreshold = 0.0f; ///< Allowed ACMR degradation for overdraw optimization, 0 to disable
+	unsigned int threads = 1;
+	float scale = 1.0f;
+	bool overrideMaterial = false;
+	std::string material;
+	std::string passes;
+};
 
-	try
+/// Record mesh size after a stage
+static void SetCounts(PipelineStats::Scope& scope, const Mesh& mesh)
+{
+	scope.SetCounts(mesh.GetNumVertices(), mesh.GetIndices().size() / 3);
+}
+
+/// Compile one input file, writing the mesh file under the given name
+/** @param samples Spherical samples for radiance transfer, only used if options.prt is set.
+	@param stats Records time spent per stage, may be nullptr. */
+static void WriteCompiledFile(const std::string& inFileName, const std::string& outFileName, const CompileOptions& options,
+		const std::vector<SphericalHarmonics::Sample<3>>& samples, PipelineStats* stats)
+{
+	PipelineStats::Scope compileScope(stats, "compile", inFileName);
+
+	std::unordered_set<Hash> toHalf = {
+		VertexAttributeInfo::kVertexPrt0,
+		VertexAttributeInfo::kVertexPrt1,
+		VertexAttributeInfo::kVertexPrt2,
+		VertexAttributeInfo::kSkinWeights
+	};
+
+	if(!options.noHalfFloatNormals)
+		toHalf.insert(VertexAttributeInfo::kNormal);
+
+	size_t totalVertices = 0;
+	size_t totalTriangles = 0;
+
+	// Processing steps applied to every mesh before writing:
+	auto processMesh = [&](Mesh& mesh, MeshCompiler::MeshExtras& extras)
 	{
-		cmd.Parse(argc, argv);
+		if(options.scale != 1.0f)
+		{
+			PipelineStats::Scope scope(stats, "scale");
+			MeshUtils::Scale(mesh, options.scale);
+			SetCounts(scope, mesh);
+		}
 
-		FileWriteStorage outFile(*outFileName);
-		MeshSet meshSet;
-		if(StringUtils::EndsWith(*inFileName, ".obj"))
+		// Precomputed radiance transfer:
+		if(options.prt)
+		{
+			PipelineStats::Scope scope(stats, "prt");
+			PrecomputedRadianceTransfer::CalculateDiffuseShadowed(mesh, samples, options.threads);
+			SetCounts(scope, mesh);
+		}
+
+		if(options.noTextureCoords)
+			mesh.RemoveAttribute(VertexAttributeInfo::kTextureCoords);
+
+		// Override material:
+		if(options.overrideMaterial)
+			mesh.SetMaterial(options.material);
+
+		// Levels of detail, simplified while skin weights are still 32 bit floats:
+		if(options.lods > 0 && mesh.GetMode() == IndexBufferInfo::Mode::kTriangles)
+		{
+			PipelineStats::Scope scope(stats, "simplify");
+			const size_t numIndices = mesh.GetIndices().size();
+			size_t previousCount = numIndices;
+			float previousError = 0.0f;
+			for(unsigned int level = 1; level <= options.lods; ++level)
+			{
+				// Each level has half the triangles of the previous one:
+				MeshCompiler::LevelOfDetail lod;
+				lod.indices = Simplifier::Simplify(mesh, (numIndices >> level) / 3 * 3, lod.error);
+
+				// Seams and borders can keep a mesh from getting simpler:
+				if(lod.indices.empty() || lod.indices.size() > previousCount * 9 / 10)
+					break;
+				lod.error = std::max(lod.error, previousError);
+				previousCount = lod.indices.size();
+				previousError = lod.error;
+				extras.lods.push_back(std::move(lod));
+			}
+			SetCounts(scope, mesh);
+		}
+
+		// Triangle order optimization:
+		{
+			PipelineStats::Scope scope(stats, "optimize triangles");
+			uint32_t* indices = mesh.GetIndices().data();
+			assert(indices);
+			TriListOpt::OptimizeTriangleOrdering(mesh.GetNumVertices(), mesh.GetIndices().size(), indices, indices);
+			for(auto& lod: extras.lods)
+				TriListOpt::OptimizeTriangleOrdering(mesh.GetNumVertices(), lod.indices.size(), lod.indices.data(), lod.indices.data());
+			SetCounts(scope, mesh);
+		}
+
+		// Cluster order for less overdraw, at the cost of some vertex cache efficiency:
+		if(options.overdrawThreshold > 0.0f && mesh.GetMode() == IndexBufferInfo::Mode::kTriangles)
+		{
+			PipelineStats::Scope scope(stats, "optimize overdraw");
+			auto& position = mesh.GetAttribute(VertexAttributeInfo::kPosition);
+			if(position.GetType() != VertexAttributeInfo::kFloat || position.GetNumComponents() != 3)
+				throw std::runtime_error("Overdraw optimization needs positions with three 32 bit float components");
+			const Vector3* positions = position.GetData<Vector3>();
+			const size_t numVertices = mesh.GetNumVertices();
+
+			// Measured only when stats are recorded, each estimate rasterizes the mesh six times:
+			auto& indices = mesh.GetIndices();
+			float acmrBefore = 0.0f;
+			float overdrawBefore = 0.0f;
+			if(stats)
+			{
+				acmrBefore = MeshAnalysis::CalculateAcmr(indices.data(), indices.size(), numVertices);
+				overdrawBefore = MeshAnalysis::EstimateOverdraw(indices.data(), indices.size(), positions, numVertices);
+			}
+			indices = OverdrawOptimizer::Optimize(indices.data(), indices.size(), positions, numVertices, options.overdrawThreshold);
+			for(auto& lod: extras.lods)
+				lod.indices = OverdrawOptimizer::Optimize(lod.indices.data(), lod.indices.size(), positions, numVertices, options.overdrawThreshold);
+
+			if(stats)
+			{
+				std::ostringstream note;
+				note.precision(3);
+				note << inFileName << " (" << mesh.GetMaterial() << "): ACMR " << acmrBefore
+						<< " -> " << MeshAnalysis::CalculateAcmr(indices.data(), indices.size(), numVertices)
+						<< ", overdraw " << overdrawBefore
+						<< " -> " << MeshAnalysis::EstimateOverdraw(indices.data(), indices.size(), positions, numVertices);
+				scope.SetNote(note.str());
+			}
+			SetCounts(scope, mesh);
+		}
+
+		// Vertices in order of first use by the optimized triangles, levels of detail follow the full resolution mesh:
 		{
-			FileReadStorage inFile(*inFileName);
+			PipelineStats::Scope scope(stats, "optimize vertex fetch");
+			const std::vector<uint32_t> remap = VertexFetchOptimizer::Optimize(mesh);
+			for(auto& lod: extras.lods)
+			{
+				for(uint32_t& index: lod.indices)
+					index = remap[index];
+			}
+			SetCounts(scope, mesh);
+		}
+
+		// Precision reduction, after all steps that need 32 bit attributes:
+		{
+			PipelineStats::Scope scope(stats, "reduce precision");
+			MeshUtils::ReducePrecision(mesh, toHalf);
+			SetCounts(scope, mesh);
+		}
+
+		// Clusters for culling, in the optimized triangle order:
+		if(options.meshlets)
+		{
+			PipelineStats::Scope scope(stats, "build meshlets");
+			extras.meshlets = Meshlets::Build(mesh);
+			if(!extras.lods.empty())
+			{
+				const Vector3* positions = mesh.GetAttribute(VertexAttributeInfo::kPosition).GetData<Vector3>();
+				for(auto& lod: extras.lods)
+					lod.meshlets = Meshlets::Build(lod.indices.data(), lod.indices.size(), positions, mesh.GetNumVertices());
+			}
+			SetCounts(scope, mesh);
+		}
+
+		totalVertices += mesh.GetNumVertices();
+		totalTriangles += mesh.GetIndices().size() / 3;
+	};
+
+	// Convert input meshes one at a time:
+	// Time spent in the visitor is subtracted from the conversion by nesting the scopes:
+	auto forEachMesh = [&](const MeshCompiler::MeshVisitor& visitor)
+	{
+		if(StringUtils::EndsWith(inFileName, ".obj"))
+		{
+			std::unique_ptr<PipelineStats::Scope> loadScope(new PipelineStats::Scope(stats, "load"));
+			FileReadStorage inFile(inFileName);
 			TextReadStream<FileReadStorage> trs(inFile);
 			ObjFile objFile(trs);
-			meshSet = MeshCompiler::ObjFileToMeshSet(objFile);
+			loadScope.reset();
+
+			PipelineStats::Scope convertScope(stats, "convert");
+			MeshCompiler::ForEachMesh(objFile, visitor);
 		}
-		else if(StringUtils::EndsWith(*inFileName, ".dae"))
+		else if(StringUtils::EndsWith(inFileName, ".dae"))
 		{
-			ColladaFile file(inFileName->c_str());
-			meshSet = ColladaToMesh::ToMesh(file);
+			std::unique_ptr<PipelineStats::Scope> loadScope(new PipelineStats::Scope(stats, "load"));
+			ColladaFile file(inFileName.c_str());
+			loadScope.reset();
+
+			PipelineStats::Scope convertScope(stats, "convert");
+			if(options.stream)
+				ColladaToMesh::ForEachMesh(file, visitor);
+			else
+			{
+				MeshSet meshes = ColladaToMesh::ToMesh(file, options.threads);
+				for(auto& mesh: meshes)
+					visitor(mesh);
+			}
 		}
 		else
 			throw std::runtime_error("Unknown input format");
+	};
 
-		if(scale)
+	const MeshCompiler::PassLayout passLayout = options.passes.empty() ? MeshCompiler::DefaultPassLayout() : MeshCompiler::ParsePassLayout(options.passes);
+	if(options.stream)
+	{
+		// Write buffers of each mesh as soon as it is processed:
+		MeshCompiler::StreamingCompiler compiler(outFileName, passLayout);
+		forEachMesh([&](Mesh& mesh){
+			MeshCompiler::MeshExtras extras;
+			processMesh(mesh, extras);
+			PipelineStats::Scope scope(stats, "write");
+			compiler.Add(mesh, extras);
+		});
+		PipelineStats::Scope scope(stats, "write");
+		compiler.Finish();
+	}
+	else
+	{
+		MeshSet meshSet;
+		std::vector<MeshCompiler::MeshExtras> extras;
+		forEachMesh([&](Mesh& mesh){
+			MeshCompiler::MeshExtras meshExtras;
+			processMesh(mesh, meshExtras);
+			meshSet.push_back(std::move(mesh));
+			extras.push_back(std::move(meshExtras));
+		});
+
+		// Finally write to file:
+		PipelineStats::Scope scope(stats, "write");
+		FileWriteStorage outFile(outFileName);
+		MeshCompiler::Compile(meshSet, outFile, passLayout, extras);
+	}
+	compileScope.SetCounts(totalVertices, totalTriangles);
+}
+
+/// Compile one input file to one mesh file
+/** The file is written under a temporary name next to outFileName and renamed when complete, so a failed compilation
+	leaves no partial output behind.
+	@see WriteCompiledFile */
+static void CompileFile(const std::string& inFileName, const std::string& outFileName, const CompileOptions& options,
+		const std::vector<SphericalHarmonics::Sample<3>>& samples, PipelineStats* stats)
+{
+	std::ostringstream tempFileName;
+	tempFileName << outFileName << ".tmp" << getpid() << "_" << std::this_thread::get_id();
+	try
+	{
+		WriteCompiledFile(inFileName, tempFileName.str(), options, samples, stats);
+	}
+	catch(...)
+	{
+		std::remove(tempFileName.str().c_str());
+		throw;
+	}
+	if(std::rename(tempFileName.str().c_str(), outFileName.c_str()) != 0)
+	{
+		CompileCache::Unlink(tempFileName.str());
+		throw std::runtime_error("Cannot write " + outFileName);
+	}
+}
+
+/// Options that change the compiled file, as part of cache keys
+static std::string DescribeOutputOptions(const CompileOptions& options)
+{
+	std::ostringstream description;
+	description << std::hexfloat
+			<< "prt=" << options.prt
+			<< " no-half-float-normals=" << options.noHalfFloatNormals
+			<< " no-texture-coords=" << options.noTextureCoords
+			<< " meshlets=" << options.meshlets
+			<< " lods=" << options.lods
+			<< " overdraw=" << options.overdrawThreshold
+			<< " scale=" << options.scale
+			<< " material=" << options.overrideMaterial << ":" << options.material
+			<< " passes=" << options.passes
+			<< " stream=" << options.stream;
+	return description.str();
+}
+
+/// Compile file or take it from the cache
+/** @param cache Cache directory, may be nullptr.
+	@param stats Records time spent per stage, may be nullptr.
+	@returns true if the output was taken from the cache. */
+static bool CompileFileCached(const std::string& inFileName, const std::string& outFileName, const CompileOptions& options,
+		const std::vector<SphericalHarmonics::Sample<3>>& samples, const CompileCache* cache, PipelineStats* stats)
+{
+	// Output may be a hard link to a read-only cache entry from an earlier run, even if this run uses no cache:
+	CompileCache::Unlink(outFileName);
+	if(!cache)
+	{
+		CompileFile(inFileName, outFileName, options, samples, stats);
+		return false;
+	}
+
+	std::string key;
+	{
+		PipelineStats::Scope scope(stats, "cache lookup", inFileName);
+		key = cache->GetKey(inFileName, DescribeOutputOptions(options));
+		if(cache->Fetch(key, outFileName))
+			return true;
+	}
+
+	CompileFile(inFileName, outFileName, options, samples, stats);
+	PipelineStats::Scope scope(stats, "cache store", inFileName);
+	cache->Store(key, outFileName);
+	return false;
+}
+
+/// Input and output file of a batch compilation
+struct BatchEntry
+{
+	std::string inFileName;
+	std::string outFileName;
+	CompileOptions options;
+};
+
+/// Split manifest line at whitespace, double quotes group words
+static std::vector<std::string> Tokenize(const std::string& line)
+{
+	std::vector<std::string> tokens;
+	size_t pos = 0;
+	while(true)
+	{
+		while(pos < line.size() && isspace(static_cast<unsigned char>(line[pos])))
+			pos++;
+		if(pos == line.size() || line[pos] == '#')
+			return tokens;
+
+		std::string token;
+		bool quoted = false;
+		for(; pos < line.size() && (quoted || !isspace(static_cast<unsigned char>(line[pos]))); ++pos)
 		{
-			for(auto& mesh: meshSet)
-				MeshUtils::Scale(mesh, *scale);
+			if(line[pos] == '"')
+				quoted = !quoted;
+			else
+				token += line[pos];
 		}
+		if(quoted)
+			throw std::runtime_error("Unterminated quote");
+		tokens.push_back(token);
+	}
+}
 
-		// Precomputed radiance transfer:
-		if(prt)
+/// Apply options following input and output file names in a manifest line
+/** Accepts the per-file options of the command line, as "--name value" or "--name=value". */
+static void ParseEntryOptions(const std::vector<std::string>& tokens, size_t first, CompileOptions& options)
+{
+	for(size_t i = first; i < tokens.size(); ++i)
+	{
+		std::string name = tokens[i];
+		std::string value;
+		bool hasValue = false;
+		const size_t equals = name.find('=');
+		if(equals != std::string::npos)
 		{
-			auto samples = SphericalHarmonics::SetupSphericalSamples<3>();
-			for(auto& mesh: meshSet)
-				PrecomputedRadianceTransfer::CalculateDiffuseShadowed(mesh, samples);
+			value = name.substr(equals + 1);
+			name.resize(equals);
+			hasValue = true;
 		}
+		auto getValue = [&]()
+		{
+			if(!hasValue)
+			{
+				if(++i == tokens.size())
+					throw std::runtime_error("Missing value for " + name);
+				value = tokens[i];
+			}
+			return value;
+		};
 
-		if(noTextureCoords)
+		if(name == "--prt")
+			options.prt = true;
+		else if(name == "--no-half-float-normals")
+			options.noHalfFloatNormals = true;
+		else if(name == "--no-texture-coords")
+			options.noTextureCoords = true;
+		else if(name == "--stream")
+			options.stream = true;
+		else if(name == "--meshlets")
+			options.meshlets = true;
+		else if(name == "--lods")
+			options.lods = std::stoul(getValue());
+		else if(name == "--overdraw")
+			options.overdrawThreshold = std::stof(getValue());
+		else if(name == "--threads")
+			options.threads = std::stoul(getValue());
+		else if(name == "--scale")
+			options.scale = std::stof(getValue());
+		else if(name == "--material")
 		{
-			for(auto& mesh: meshSet)
-				mesh.RemoveAttribute(VertexAttributeInfo::kTextureCoords);
+			options.material = getValue();
+			options.overrideMaterial = true;
 		}
+		else if(name == "--passes")
+			options.passes = getValue();
+		else
+			throw std::runtime_error("Unknown option " + name);
+	}
+}
 
-		// Override material:
-		if(material)
+static std::string JoinPath(const std::string& directory, const std::string& fileName)
+{
+	if(directory.empty() || fileName.empty() || fileName[0] == '/')
+		return fileName;
+	if(directory.back() == '/')
+		return directory + fileName;
+	return directory + "/" + fileName;
+}
+
+/// Output file name for an input file found in a directory or by a pattern
+static std::string OutputFileName(const std::string& outDirectory, const std::string& inFileName)
+{
+	const size_t slash = inFileName.rfind('/');
+	std::string name = (slash == std::string::npos) ? inFileName : inFileName.substr(slash + 1);
+	name.resize(name.rfind('.'));
+	return JoinPath(outDirectory, name + ".mmf");
+}
+
+static bool IsInputFile(const std::string& fileName)
+{
+	return StringUtils::EndsWith(fileName, ".obj") || StringUtils::EndsWith(fileName, ".dae");
+}
+
+/// Read batch entries from a manifest, a directory or a glob pattern
+/** Manifest lines contain input file, output file and optional per-file options. Input files are relative to the
+	manifest, output files relative to outDirectory. Empty lines and lines starting with '#' are ignored. Directories
+	and patterns compile every OBJ and COLLADA file to outDirectory/<name>.mmf.
+	@throws std::runtime_error if two entries have the same output file. */
+static std::vector<BatchEntry> ReadBatchEntries(const std::string& source, const std::string& outDirectory, const CompileOptions& options)
+{
+	std::vector<BatchEntry> entries;
+	std::vector<std::string> inFileNames;
+
+	struct stat st;
+	if(stat(source.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+	{
+		DIR* dir = opendir(source.c_str());
+		if(!dir)
+			throw std::runtime_error("Cannot open directory " + source);
+		while(dirent* entry = readdir(dir))
+		{
+			if(IsInputFile(entry->d_name))
+				inFileNames.push_back(JoinPath(source, entry->d_name));
+		}
+		closedir(dir);
+		std::sort(inFileNames.begin(), inFileNames.end());
+	}
+	else if(source.find_first_of("*?[") != std::string::npos)
+	{
+		glob_t matches;
+		const int result = glob(source.c_str(), 0, nullptr, &matches);
+		if(result != 0 && result != GLOB_NOMATCH)
+			throw std::runtime_error("Cannot expand pattern " + source);
+		for(size_t i = 0; i < matches.gl_pathc; ++i)
 		{
-			for(auto& mesh: meshSet)
-				mesh.SetMaterial(*material);
+			if(IsInputFile(matches.gl_pathv[i]))
+				inFileNames.push_back(matches.gl_pathv[i]);
 		}
+		globfree(&matches);
+	}
+	else
+	{
+		std::ifstream manifest(source);
+		if(!manifest)
+			throw std::runtime_error("Cannot open manifest " + source);
+		const size_t slash = source.rfind('/');
+		const std::string manifestDirectory = (slash == std::string::npos) ? std::string() : source.substr(0, slash + 1);
+		std::string line;
+		for(unsigned int lineNumber = 1; std::getline(manifest, line); ++lineNumber)
+		{
+			try
+			{
+				auto tokens = Tokenize(line);
+				if(tokens.empty())
+					continue;
+				if(tokens.size() < 2)
+					throw std::runtime_error("Expected input and output file");
+				BatchEntry entry;
+				entry.inFileName = JoinPath(manifestDirectory, tokens[0]);
+				entry.outFileName = JoinPath(outDirectory, tokens[1]);
+				entry.options = options;
+				ParseEntryOptions(tokens, 2, entry.options);
+				entries.push_back(entry);
+			}
+			catch(std::exception& e)
+			{
+				throw std::runtime_error(source + ":" + std::to_string(lineNumber) + ": " + e.what());
+			}
+		}
+	}
 
-		std::unordered_set<Hash> toHalf = {
-			VertexAttributeInfo::kVertexPrt0,
-			VertexAttributeInfo::kVertexPrt1,
-			VertexAttributeInfo::kVertexPrt2,
-			VertexAttributeInfo::kSkinWeights
-		};
+	for(auto& inFileName: inFileNames)
+	{
+		BatchEntry entry;
+		entry.inFileName = inFileName;
+		entry.outFileName = OutputFileName(outDirectory, inFileName);
+		entry.options = options;
+		entries.push_back(entry);
+	}
+
+	// Workers must not write the same file at once, e.g. for foo.obj and foo.dae:
+	std::map<std::string, const BatchEntry*> outputs;
+	for(auto& entry: entries)
+	{
+		auto inserted = outputs.insert(std::make_pair(entry.outFileName, &entry));
+		if(!inserted.second)
+			throw std::runtime_error(inserted.first->second->inFileName + " and " + entry.inFileName + " both compile to " + entry.outFileName);
+	}
+	return entries;
+}
 
-		if(!noHalfFloatNormals)
-			toHalf.insert(VertexAttributeInfo::kNormal);
+/// Create batch output directory unless it exists
+static void CreateOutputDirectory(const std::string& directory)
+{
+	struct stat st;
+	if(mkdir(directory.c_str(), 0777) != 0
+			&& (errno != EEXIST || stat(directory.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)))
+		throw std::runtime_error("Cannot create output directory " + directory);
+}
 
-		// Precision reduction:
-		for(auto& mesh: meshSet)
-			MeshUtils::ReducePrecision(mesh, toHalf);
+/// Compile batch entries on a pool of worker threads and print status and timing of each file
+/** @returns Number of files that failed to compile. */
+static unsigned int CompileBatch(const std::vector<BatchEntry>& entries, unsigned int numJobs, const CompileCache* cache, PipelineStats* stats)
+{
+	if(numJobs == 0)
+		numJobs = std::max(1u, std::thread::hardware_concurrency());
+	numJobs = std::min<size_t>(numJobs, std::max<size_t>(entries.size(), 1));
 
-		// Triangle order optimization:
-		for(auto& mesh: meshSet)
+	// Set up once and shared by all files:
+	std::vector<SphericalHarmonics::Sample<3>> samples;
+	if(std::any_of(entries.begin(), entries.end(), [](const BatchEntry& entry){return entry.options.prt;}))
+	{
+		PipelineStats::Scope scope(stats, "setup samples");
+		samples = SphericalHarmonics::SetupSphericalSamples<3>();
+	}
+
+	typedef std::chrono::steady_clock Clock;
+	const Clock::time_point batchStart = Clock::now();
+	std::atomic<size_t> nextEntry(0);
+	std::atomic<unsigned int> numFailed(0);
+	size_t numFinished = 0;
+	std::mutex outputMutex;
+
+	std::vector<std::thread> workers;
+	for(unsigned int j = 0; j < numJobs; ++j)
+	{
+		workers.emplace_back([&]()
 		{
-			uint32_t* indices = mesh.GetIndices().data();
-			assert(indices);
-			TriListOpt::OptimizeTriangleOrdering(mesh.GetNumVertices(), mesh.GetIndices().size(), indices, indices);
+			for(size_t i = nextEntry++; i < entries.size(); i = nextEntry++)
+			{
+				const BatchEntry& entry = entries[i];
+				const Clock::time_point start = Clock::now();
+				std::string error;
+				bool cached = false;
+				try
+				{
+					cached = CompileFileCached(entry.inFileName, entry.outFileName, entry.options, samples, cache, stats);
+				}
+				catch(std::exception& e)
+				{
+					error = e.what();
+					numFailed++;
+				}
+				const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+				std::lock_guard<std::mutex> lock(outputMutex);
+				numFinished++;
+				std::ostringstream status;
+				status << "[" << numFinished << "/" << entries.size() << "] ";
+				if(error.empty())
+					std::cout << status.str() << entry.inFileName << " -> " << entry.outFileName << " (" << (cached ? "cached, " : "") << seconds << " s)" << std::endl;
+				else
+					std::cerr << status.str() << entry.inFileName << " FAILED: " << error << " (" << seconds << " s)" << std::endl;
+			}
+		});
+	}
+	for(auto& worker: workers)
+		worker.join();
+
+	const double seconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+	std::cout << entries.size() - numFailed << " compiled, " << numFailed << " failed in " << seconds << " s" << std::endl;
+	return numFailed;
+}
+
+int main(int argc, char** argv)
+{
+	CommandLineParser cmd;
+	CommandLineParser::PositionalArg<std::string> inFileName(cmd, "input", "Input mesh to compile, or manifest, directory or glob pattern with --batch");
+	CommandLineParser::PositionalArg<std::string> outFileName(cmd, "output", "Output compiled mesh file, or output directory with --batch");
+	CommandLineParser::Flag prt(cmd, "prt", "Enable radiance transfer precomputation");
+	CommandLineParser::Flag noHalfFloatNormals(cmd, "no-half-float-normals", "Store normals as 32 bit floats instead of 16 bit");
+	CommandLineParser::Flag noTextureCoords(cmd, "no-texture-coords", "Don't store texture coordinates");
+	CommandLineParser::Option<unsigned int> threads(cmd, "threads", "Number of threads for COLLADA conversion and radiance transfer precomputation, 0 for all cores", 1);
+	CommandLineParser::Option<float> scale(cmd, "scale", "Mesh scale factor", 1.0);
+	CommandLineParser::Option<std::string> material(cmd, "material", "Override material string (of all submeshes)");
+	CommandLineParser::Option<std::string> passes(cmd, "passes", "Vertex attributes per render pass, e.g. \"vertexPositionAttr;vertexNormalAttr,vertexUv0Attr\"");
+	CommandLineParser::Flag meshlets(cmd, "meshlets", "Split meshes into clusters of up to 64 vertices and 124 triangles with bounds for culling");
+	CommandLineParser::Option<unsigned int> lods(cmd, "lods", "Number of simplified levels of detail, each with half the triangles of the previous one", 0);
+	CommandLineParser::Option<float> overdraw(cmd, "overdraw", "Reorder triangle clusters to reduce overdraw, letting the vertex cache miss ratio grow by up to this factor, e.g. 1.05");
+	CommandLineParser::Flag stream(cmd, "stream", "Write each mesh as soon as it is processed instead of keeping all meshes in memory");
+	CommandLineParser::Flag batch(cmd, "batch", "Compile all files listed in a manifest (lines of \"input output [options]\"), in a directory or matching a pattern");
+	CommandLineParser::Option<unsigned int> jobs(cmd, "jobs", "Number of files compiled at the same time with --batch, 0 for all cores", 1);
+	CommandLineParser::Option<std::string> cacheDirectory(cmd, "cache", "Directory of previously compiled files, keyed by input contents and options");
+	CommandLineParser::Flag printStats(cmd, "stats", "Print time, CPU time and mesh sizes per stage and peak memory");
+	CommandLineParser::Option<std::string> trace(cmd, "trace", "Write stages to a JSON file in Chrome trace event format");
+	CommandLineParser::HelpFlag help(cmd);
+
+	try
+	{
+		cmd.Parse(argc, argv);
+
+		CompileOptions options;
+		options.prt = prt;
+		options.noHalfFloatNormals = noHalfFloatNormals;
+		options.noTextureCoords = noTextureCoords;
+		options.stream = stream;
+		options.meshlets = meshlets;
+		options.lods = *lods;
+		if(overdraw)
+			options.overdrawThreshold = *overdraw;
+		options.threads = *threads;
+		if(scale)
+			options.scale = *scale;
+		if(material)
+		{
+			options.overrideMaterial = true;
+			options.material = *material;
 		}
+		if(passes)
+			options.passes = *passes;
 
-		// Finally write to file:
-		MeshCompiler::Compile(meshSet, outFile);
+		unsigned int numFailed = 0;
+		std::unique_ptr<PipelineStats> stats;
+		if(printStats || trace)
+			stats.reset(new PipelineStats);
+
+		std::unique_ptr<CompileCache> cache;
+		if(cacheDirectory)
+			cache.reset(new CompileCache(*cacheDirectory));
+
+		if(batch)
+		{
+			const auto entries = ReadBatchEntries(*inFileName, *outFileName, options);
+			CreateOutputDirectory(*outFileName);
+			numFailed = CompileBatch(entries, *jobs, cache.get(), stats.get());
+		}
+		else
+		{
+			std::vector<SphericalHarmonics::Sample<3>> samples;
+			if(options.prt)
+			{
+				PipelineStats::Scope scope(stats.get(), "setup samples");
+				samples = SphericalHarmonics::SetupSphericalSamples<3>();
+			}
+			CompileFileCached(*inFileName, *outFileName, options, samples, cache.get(), stats.get());
+		}
+
+		if(printStats)
+			stats->PrintSummary(std::cerr);
+		if(trace)
+			stats->WriteTrace(*trace);
+		if(numFailed > 0)
+			return EXIT_FAILURE;
 	}
 	catch(std::exception& e)
 	{
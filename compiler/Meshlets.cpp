@@ -0,0 +1,193 @@
+/*	Meshlets.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Meshlets.h"
+#include <molecular/util/Mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace molecular
+{
+using namespace util;
+using namespace meshfile;
+
+namespace Meshlets
+{
+
+/// Unit normal of a triangle
+/** @returns false for degenerate triangles. */
+static bool GetNormal(const Vector3& a, const Vector3& b, const Vector3& c, float outNormal[3])
+{
+	const float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+	const float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+	const float n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+	const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if(!(length > 0.0f))
+		return false;
+	for(int i = 0; i < 3; ++i)
+		outNormal[i] = n[i] / length;
+	return true;
+}
+
+/// Calculate bounding sphere and normal cone of the triangles in meshlet
+static void CalculateBounds(const uint32_t* indices, const Vector3* positions, MeshFile::Meshlet& meshlet)
+{
+	const uint32_t* begin = indices + meshlet.indexOffset;
+	const uint32_t* end = begin + meshlet.indexCount;
+
+	// Sphere around the center of the bounding box:
+	float boundsMin[3], boundsMax[3];
+	for(int i = 0; i < 3; ++i)
+	{
+		boundsMin[i] = std::numeric_limits<float>::max();
+		boundsMax[i] = -std::numeric_limits<float>::max();
+	}
+	for(const uint32_t* index = begin; index != end; ++index)
+	{
+		for(int i = 0; i < 3; ++i)
+		{
+			boundsMin[i] = std::min(boundsMin[i], positions[*index][i]);
+			boundsMax[i] = std::max(boundsMax[i], positions[*index][i]);
+		}
+	}
+	for(int i = 0; i < 3; ++i)
+		meshlet.center[i] = 0.5f * (boundsMin[i] + boundsMax[i]);
+	float radiusSquared = 0.0f;
+	for(const uint32_t* index = begin; index != end; ++index)
+	{
+		float distanceSquared = 0.0f;
+		for(int i = 0; i < 3; ++i)
+		{
+			const float d = positions[*index][i] - meshlet.center[i];
+			distanceSquared += d * d;
+		}
+		radiusSquared = std::max(radiusSquared, distanceSquared);
+	}
+	meshlet.radius = std::sqrt(radiusSquared);
+
+	// Cone around the average normal, degenerate triangles are never visible:
+	std::vector<float> normals;
+	float axis[3] = {0.0f, 0.0f, 0.0f};
+	for(const uint32_t* tri = begin; tri + 2 < end; tri += 3)
+	{
+		float normal[3];
+		if(!GetNormal(positions[tri[0]], positions[tri[1]], positions[tri[2]], normal))
+			continue;
+		normals.insert(normals.end(), normal, normal + 3);
+		for(int i = 0; i < 3; ++i)
+			axis[i] += normal[i];
+	}
+	const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	meshlet.coneCutoff = 1.0f;
+	for(int i = 0; i < 3; ++i)
+		meshlet.coneAxis[i] = axisLength > 0.0f ? axis[i] / axisLength : 0.0f;
+	if(!(axisLength > 0.0f))
+		return;
+
+	float minDot = 1.0f;
+	for(size_t n = 0; n < normals.size(); n += 3)
+		minDot = std::min(minDot, normals[n] * meshlet.coneAxis[0] + normals[n + 1] * meshlet.coneAxis[1] + normals[n + 2] * meshlet.coneAxis[2]);
+	if(minDot > 0.0f)
+		meshlet.coneCutoff = std::min(1.0f, std::sqrt(1.0f - minDot * minDot));
+}
+
+std::vector<MeshFile::Meshlet> Build(const uint32_t* indices, size_t numIndices,
+		const Vector3* positions, size_t numVertices,
+		unsigned int maxVertices, unsigned int maxTriangles)
+{
+	if(maxVertices < 3 || maxTriangles < 1)
+		throw std::invalid_argument("Meshlets need room for at least one triangle");
+
+	std::vector<MeshFile::Meshlet> meshlets;
+	MeshFile::Meshlet current = MeshFile::Meshlet();
+
+	// Number of the last meshlet referencing each vertex:
+	std::vector<uint32_t> usedBy(numVertices, std::numeric_limits<uint32_t>::max());
+
+	const size_t numTriangleIndices = numIndices - numIndices % 3;
+	for(size_t i = 0; i < numTriangleIndices; i += 3)
+	{
+		const uint32_t* tri = indices + i;
+		for(int k = 0; k < 3; ++k)
+		{
+			if(tri[k] >= numVertices)
+				throw std::runtime_error("Index out of range");
+		}
+
+		auto countNewVertices = [&]()
+		{
+			const uint32_t meshlet = meshlets.size();
+			unsigned int count = 0;
+			for(int k = 0; k < 3; ++k)
+			{
+				if(usedBy[tri[k]] != meshlet && (k < 1 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1]))
+					count++;
+			}
+			return count;
+		};
+
+		unsigned int newVertices = countNewVertices();
+		if(current.vertexCount + newVertices > maxVertices || current.indexCount / 3 >= maxTriangles)
+		{
+			CalculateBounds(indices, positions, current);
+			meshlets.push_back(current);
+			current = MeshFile::Meshlet();
+			current.indexOffset = i;
+			newVertices = countNewVertices();
+		}
+
+		for(int k = 0; k < 3; ++k)
+			usedBy[tri[k]] = meshlets.size();
+		current.vertexCount += newVertices;
+		current.indexCount += 3;
+	}
+
+	if(current.indexCount > 0)
+	{
+		CalculateBounds(indices, positions, current);
+		meshlets.push_back(current);
+	}
+	return meshlets;
+}
+
+std::vector<MeshFile::Meshlet> Build(const Mesh& mesh, unsigned int maxVertices, unsigned int maxTriangles)
+{
+	if(mesh.GetMode() != IndexBufferInfo::Mode::kTriangles)
+		return std::vector<MeshFile::Meshlet>();
+
+	auto& attribute = mesh.GetAttribute(VertexAttributeInfo::kPosition);
+	if(attribute.GetType() != VertexAttributeInfo::kFloat || attribute.GetNumComponents() != 3)
+		throw std::runtime_error("Meshlets need positions with three 32 bit float components");
+
+	auto& indices = mesh.GetIndices();
+	return Build(indices.data(), indices.size(), attribute.GetData<Vector3>(), mesh.GetNumVertices(), maxVertices, maxTriangles);
+}
+
+}
+
+} // namespace molecular
@@ -0,0 +1,69 @@
+/*	Meshlets.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_MESHLETS_H
+#define MOLECULAR_MESHLETS_H
+
+#include <molecular/meshfile/MeshFile.h>
+#include <molecular/util/Vector3.h>
+#include <vector>
+
+namespace molecular
+{
+
+namespace util
+{
+class Mesh;
+}
+
+/// Partitioning of triangle lists into small clusters for culling on the GPU
+namespace Meshlets
+{
+
+/// Default limit of distinct vertices per meshlet, a common mesh shader output size
+const unsigned int kMaxVertices = 64;
+
+/// Default limit of triangles per meshlet
+const unsigned int kMaxTriangles = 124;
+
+/// Split triangle list into meshlets without changing the triangle order
+/** Triangles are added to the current meshlet in index order until one of the limits would be exceeded. After
+	optimizing the triangle order for the vertex cache, consecutive triangles are mostly neighbors, so this keeps both
+	the cache efficiency and compact meshlets.
+	@returns Meshlets covering all triangles in order, with bounding spheres and normal cones. */
+std::vector<meshfile::MeshFile::Meshlet> Build(const uint32_t* indices, size_t numIndices,
+		const util::Vector3* positions, size_t numVertices,
+		unsigned int maxVertices = kMaxVertices, unsigned int maxTriangles = kMaxTriangles);
+
+/// Split the triangles of a mesh into meshlets
+/** @returns No meshlets if the mesh is not a triangle list. */
+std::vector<meshfile::MeshFile::Meshlet> Build(const util::Mesh& mesh,
+		unsigned int maxVertices = kMaxVertices, unsigned int maxTriangles = kMaxTriangles);
+
+}
+
+} // namespace molecular
+
+#endif // MOLECULAR_MESHLETS_H
@@ -0,0 +1,269 @@
+/*	NumberParser.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_NUMBERPARSER_H
+#define MOLECULAR_NUMBERPARSER_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Parsing of whitespace separated number lists as found in COLLADA and similar text formats
+/** Plain decimal numbers are converted without calling into the C library. Results are identical to strtof() and
+	strtol(..., 0) in the "C" locale: the fast path only accepts input where it can prove the result correctly rounded and
+	hands everything else (hexadecimal, octal, inf, nan, more than 19 digits, large exponents) to the C library. */
+namespace NumberParser
+{
+
+/// Whitespace as defined by isspace() in the "C" locale
+inline bool IsSpace(char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/// Number terminated by whitespace or end of string
+inline bool IsTokenEnd(char c)
+{
+	return c == '\0' || IsSpace(c);
+}
+
+/// Decimal digits of a number, without sign
+struct DecimalNumber
+{
+	uint64_t mantissa = 0;
+	int exponent = 0; ///< Power of ten the mantissa is multiplied with
+	const char* end = nullptr;
+};
+
+/// Parse "[digits][.digits][e[+-]digits]" with at most 19 significant digits
+/** @returns false if the text is not of this form or does not end at whitespace. */
+inline bool ParseDecimal(const char* text, DecimalNumber& out)
+{
+	const char* p = text;
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int numDigits = 0;
+	int exponent = 0;
+
+	for(; *p >= '0' && *p <= '9'; ++p, ++numDigits)
+	{
+		if(mantissa == 0 && *p == '0')
+			continue; // Leading zero
+		if(++significantDigits > 19)
+			return false;
+		mantissa = mantissa * 10 + (*p - '0');
+	}
+	if(*p == '.')
+	{
+		for(++p; *p >= '0' && *p <= '9'; ++p, ++numDigits)
+		{
+			exponent--;
+			if(mantissa == 0 && *p == '0')
+				continue;
+			if(++significantDigits > 19)
+				return false;
+			mantissa = mantissa * 10 + (*p - '0');
+		}
+	}
+	if(numDigits == 0)
+		return false;
+
+	if(*p == 'e' || *p == 'E')
+	{
+		const char* e = p + 1;
+		bool negative = false;
+		if(*e == '+' || *e == '-')
+			negative = (*e++ == '-');
+		if(*e < '0' || *e > '9')
+			return false;
+		int explicitExponent = 0;
+		for(; *e >= '0' && *e <= '9'; ++e)
+		{
+			if(explicitExponent < 100000)
+				explicitExponent = explicitExponent * 10 + (*e - '0');
+		}
+		exponent += negative ? -explicitExponent : explicitExponent;
+		p = e;
+	}
+
+	if(!IsTokenEnd(*p))
+		return false;
+	out.mantissa = mantissa;
+	out.exponent = exponent;
+	out.end = p;
+	return true;
+}
+
+/// Convert decimal number to float with correct rounding
+/** Uses exact powers of ten in double precision (Clinger's fast path). The double result is correctly rounded, so
+	converting it to float gives the correctly rounded float unless it lies exactly halfway between two floats.
+	@returns false if the number is outside the range where this works. */
+inline bool DecimalToFloat(const DecimalNumber& number, float& out)
+{
+	static const double kPowersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	if(number.mantissa == 0)
+	{
+		out = 0.0f;
+		return true;
+	}
+	if(number.mantissa > (uint64_t(1) << 53) || number.exponent < -22 || number.exponent > 22)
+		return false;
+
+	double value = double(number.mantissa);
+	if(number.exponent < 0)
+		value /= kPowersOfTen[-number.exponent];
+	else
+		value *= kPowersOfTen[number.exponent];
+
+	// The 29 low mantissa bits are dropped when converting to float:
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	if((bits & ((uint64_t(1) << 29) - 1)) == (uint64_t(1) << 28))
+		return false;
+
+	out = float(value);
+	return true;
+}
+
+/// Parse float after leading whitespace
+/** @param[out] end Set to the first character after the number, or to text if there is no number. */
+inline float ParseFloat(const char* text, const char*& end)
+{
+	const char* p = text;
+	while(IsSpace(*p))
+		++p;
+	const bool negative = (*p == '-');
+	const char* digits = (*p == '-' || *p == '+') ? p + 1 : p;
+
+	DecimalNumber number;
+	float value;
+	if(ParseDecimal(digits, number) && DecimalToFloat(number, value))
+	{
+		end = number.end;
+		return negative ? -value : value;
+	}
+
+	char* endPtr = nullptr;
+	value = strtof(text, &endPtr);
+	end = endPtr;
+	return value;
+}
+
+/// Parse integer after leading whitespace, with prefixes for octal and hexadecimal like strtol(..., 0)
+/** @param[out] end Set to the first character after the number, or to text if there is no number. */
+inline int ParseInt(const char* text, const char*& end)
+{
+	const char* p = text;
+	while(IsSpace(*p))
+		++p;
+	const bool negative = (*p == '-');
+	if(*p == '-' || *p == '+')
+		++p;
+
+	// Decimal numbers of up to 18 digits without leading zero:
+	if(*p >= '1' && *p <= '9')
+	{
+		int64_t value = 0;
+		const char* digits = p;
+		for(; *p >= '0' && *p <= '9' && p - digits < 18; ++p)
+			value = value * 10 + (*p - '0');
+		if(IsTokenEnd(*p))
+		{
+			end = p;
+			return int(negative ? -value : value);
+		}
+	}
+	else if(*p == '0' && IsTokenEnd(p[1]))
+	{
+		end = p + 1;
+		return 0;
+	}
+
+	char* endPtr = nullptr;
+	const int value = strtol(text, &endPtr, 0);
+	end = endPtr;
+	return value;
+}
+
+/// Limit size hint to the number of values the text can hold, so that a wrong count cannot cause huge allocations
+inline size_t ClampSizeHint(const char* text, size_t sizeHint)
+{
+	const size_t maxValues = std::strlen(text) / 2 + 1;
+	return sizeHint < maxValues ? sizeHint : maxValues;
+}
+
+/// Parse whitespace separated floats until the first character that does not start a number
+/** @param sizeHint Expected number of values, for example from a count attribute. */
+inline std::vector<float> ReadFloatArray(const char* text, size_t sizeHint = 0)
+{
+	std::vector<float> out;
+	out.reserve(ClampSizeHint(text, sizeHint));
+	const char* beginPtr = text;
+	const char* endPtr = nullptr;
+	while(true)
+	{
+		float value = ParseFloat(beginPtr, endPtr);
+		if(beginPtr == endPtr)
+			break;
+		out.push_back(value);
+		beginPtr = endPtr;
+	}
+	return out;
+}
+
+/// Parse whitespace separated integers until the first character that does not start a number
+/** @param sizeHint Expected number of values, for example from a count attribute. */
+inline std::vector<int> ReadIntArray(const char* text, size_t sizeHint = 0)
+{
+	std::vector<int> out;
+	out.reserve(ClampSizeHint(text, sizeHint));
+	const char* beginPtr = text;
+	const char* endPtr = nullptr;
+	while(true)
+	{
+		int value = ParseInt(beginPtr, endPtr);
+		if(beginPtr == endPtr)
+			break;
+		out.push_back(value);
+		beginPtr = endPtr;
+	}
+	return out;
+}
+
+}
+}
+} // namespace molecular
+
+#endif // MOLECULAR_NUMBERPARSER_H
@@ -0,0 +1,186 @@
+/*	OverdrawOptimizer.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "OverdrawOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace molecular
+{
+using namespace util;
+
+namespace OverdrawOptimizer
+{
+
+/// FIFO post-transform cache simulation
+class CacheSimulation
+{
+public:
+	CacheSimulation(size_t numVertices, unsigned int cacheSize) :
+		mCacheSize(cacheSize),
+		mLoadedAt(numVertices, -int64_t(cacheSize) - 1)
+	{}
+
+	/// @returns Number of vertices of the triangle that had to be transformed
+	unsigned int Draw(const uint32_t* tri)
+	{
+		unsigned int misses = 0;
+		for(int k = 0; k < 3; ++k)
+		{
+			if(mTime - mLoadedAt[tri[k]] > mCacheSize)
+			{
+				mLoadedAt[tri[k]] = mTime++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	/// Forget all cached vertices
+	void Flush()
+	{
+		mTime += mCacheSize + 1;
+	}
+
+private:
+	int64_t mCacheSize;
+	int64_t mTime = 0;
+	std::vector<int64_t> mLoadedAt;
+};
+
+std::vector<uint32_t> Optimize(const uint32_t* indices, size_t numIndices,
+		const Vector3* positions, size_t numVertices,
+		float threshold, unsigned int cacheSize)
+{
+	if(!(threshold >= 1.0f))
+		throw std::invalid_argument("Overdraw optimization threshold must be at least 1");
+
+	const size_t numTriangles = numIndices / 3;
+	for(size_t i = 0; i < numTriangles * 3; ++i)
+	{
+		if(indices[i] >= numVertices)
+			throw std::runtime_error("Index out of range");
+	}
+	if(numTriangles == 0)
+		return std::vector<uint32_t>();
+
+	// Hard boundaries where the cache optimizer started over:
+	std::vector<size_t> hardStarts;
+	CacheSimulation cache(numVertices, cacheSize);
+	for(size_t t = 0; t < numTriangles; ++t)
+	{
+		if(cache.Draw(indices + t * 3) == 3 || t == 0)
+			hardStarts.push_back(t);
+	}
+	hardStarts.push_back(numTriangles);
+
+	// Split into smaller clusters as long as that keeps their ACMR below the threshold:
+	std::vector<size_t> starts;
+	for(size_t c = 0; c + 1 < hardStarts.size(); ++c)
+	{
+		const size_t begin = hardStarts[c], end = hardStarts[c + 1];
+		cache.Flush();
+		unsigned int clusterMisses = 0;
+		for(size_t t = begin; t < end; ++t)
+			clusterMisses += cache.Draw(indices + t * 3);
+		const float clusterThreshold = threshold * clusterMisses / (end - begin);
+
+		cache.Flush();
+		starts.push_back(begin);
+		unsigned int misses = 0;
+		size_t numDrawn = 0;
+		for(size_t t = begin; t < end; ++t)
+		{
+			misses += cache.Draw(indices + t * 3);
+			numDrawn++;
+			if(t + 1 < end && float(misses) / numDrawn <= clusterThreshold)
+			{
+				starts.push_back(t + 1);
+				cache.Flush();
+				misses = 0;
+				numDrawn = 0;
+			}
+		}
+	}
+	starts.push_back(numTriangles);
+
+	// Area weighted centroids and normals:
+	auto accumulate = [&](size_t begin, size_t end, double centroid[3], double normal[3])
+	{
+		double area = 0.0;
+		for(int k = 0; k < 3; ++k)
+			centroid[k] = normal[k] = 0.0;
+		for(size_t t = begin; t < end; ++t)
+		{
+			const Vector3& a = positions[indices[t * 3]];
+			const Vector3& b = positions[indices[t * 3 + 1]];
+			const Vector3& c = positions[indices[t * 3 + 2]];
+			const double u[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+			const double v[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+			const double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+			const double triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for(int k = 0; k < 3; ++k)
+			{
+				centroid[k] += triangleArea * (double(a[k]) + b[k] + c[k]) / 3.0;
+				normal[k] += n[k];
+			}
+			area += triangleArea;
+		}
+		for(int k = 0; k < 3; ++k)
+			centroid[k] = area > 0.0 ? centroid[k] / area : 0.0;
+	};
+
+	double meshCentroid[3], meshNormal[3];
+	accumulate(0, numTriangles, meshCentroid, meshNormal);
+
+	// Clusters facing away from the center first:
+	const size_t numClusters = starts.size() - 1;
+	std::vector<std::pair<double, size_t>> order(numClusters);
+	for(size_t c = 0; c < numClusters; ++c)
+	{
+		double centroid[3], normal[3];
+		accumulate(starts[c], starts[c + 1], centroid, normal);
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		double dot = 0.0;
+		for(int k = 0; k < 3; ++k)
+			dot += (centroid[k] - meshCentroid[k]) * normal[k];
+		order[c] = std::make_pair(length > 0.0 ? -dot / length : 0.0, c);
+	}
+	std::stable_sort(order.begin(), order.end(), [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b){
+		return a.first < b.first;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(numTriangles * 3);
+	for(auto& entry: order)
+		result.insert(result.end(), indices + starts[entry.second] * 3, indices + starts[entry.second + 1] * 3);
+	return result;
+}
+
+}
+
+} // namespace molecular
@@ -0,0 +1,58 @@
+/*	OverdrawOptimizer.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_OVERDRAWOPTIMIZER_H
+#define MOLECULAR_OVERDRAWOPTIMIZER_H
+
+#include <molecular/util/Vector3.h>
+#include <cstdint>
+#include <vector>
+
+namespace molecular
+{
+
+/// View independent triangle reordering for less overdraw
+/** Follows Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (2007):
+	the vertex cache optimized triangle order is cut into clusters, which are then sorted so that clusters facing
+	away from the mesh center are drawn first. These are likely to occlude the others from most view points. */
+namespace OverdrawOptimizer
+{
+
+/// Reorder clusters of a vertex cache optimized triangle list
+/** Clusters start where the cache simulation misses all three vertices of a triangle, i.e. where the cache optimizer
+	started over. These are split further as soon as their running ACMR drops to threshold times the ACMR of the whole
+	cluster. Smaller clusters sort better but start with a cold cache more often.
+	@param threshold Allowed factor of ACMR degradation, at least 1. 1.05 is a good start.
+	@param cacheSize FIFO cache size for the simulation, the size the triangle order was optimized for.
+	@returns Triangles of indices in the new order. */
+std::vector<uint32_t> Optimize(const uint32_t* indices, size_t numIndices,
+		const util::Vector3* positions, size_t numVertices,
+		float threshold, unsigned int cacheSize = 32);
+
+}
+
+} // namespace molecular
+
+#endif // MOLECULAR_OVERDRAWOPTIMIZER_H
@@ -0,0 +1,257 @@
+/*	PipelineStats.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "PipelineStats.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+
+#include <sys/resource.h>
+#include <time.h>
+
+namespace molecular
+{
+
+/// Innermost scope of the current thread
+static thread_local PipelineStats::Scope* tCurrentScope = nullptr;
+
+PipelineStats::Scope::Scope(PipelineStats* stats, const char* stage, const std::string& detail) :
+	mStats(stats),
+	mStage(stage),
+	mParent(nullptr),
+	mStartWall(0),
+	mStartCpu(0)
+{
+	if(!mStats)
+		return;
+	mDetail = detail;
+	mParent = tCurrentScope;
+	tCurrentScope = this;
+	mStartWall = GetWallTime();
+	mStartCpu = GetCpuTime();
+}
+
+PipelineStats::Scope::~Scope()
+{
+	if(!mStats)
+		return;
+	const uint64_t wall = GetWallTime() - mStartWall;
+	const uint64_t cpu = GetCpuTime() - mStartCpu;
+	tCurrentScope = mParent;
+	if(mParent)
+	{
+		mParent->mChildWall += wall;
+		mParent->mChildCpu += cpu;
+	}
+
+	Event event;
+	event.stage = mStage;
+	event.detail = mDetail;
+	event.thread = std::this_thread::get_id();
+	event.start = mStartWall - mStats->mStartWall;
+	event.duration = wall;
+	event.selfWall = wall > mChildWall ? wall - mChildWall : 0;
+	event.selfCpu = cpu > mChildCpu ? cpu - mChildCpu : 0;
+	event.peakRss = GetPeakRss();
+	event.vertices = mVertices;
+	event.triangles = mTriangles;
+	event.note = mNote;
+	mStats->Add(event);
+}
+
+void PipelineStats::Scope::SetCounts(size_t vertices, size_t triangles)
+{
+	mVertices = vertices;
+	mTriangles = triangles;
+}
+
+void PipelineStats::Scope::SetNote(const std::string& note)
+{
+	if(mStats)
+		mNote = note;
+}
+
+PipelineStats::PipelineStats() :
+	mStartWall(GetWallTime()),
+	mStartCpu(GetCpuTime())
+{
+}
+
+void PipelineStats::PrintSummary(std::ostream& out) const
+{
+	struct StageTotals
+	{
+		size_t calls = 0;
+		uint64_t wall = 0;
+		uint64_t cpu = 0;
+		size_t vertices = 0;
+		size_t triangles = 0;
+	};
+
+	// Stages in order of first completion:
+	std::vector<std::string> stages;
+	std::map<std::string, StageTotals> totals;
+	std::vector<std::pair<const char*, std::string>> notes;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for(auto& event: mEvents)
+		{
+			auto it = totals.find(event.stage);
+			if(it == totals.end())
+			{
+				stages.push_back(event.stage);
+				it = totals.emplace(event.stage, StageTotals()).first;
+			}
+			it->second.calls++;
+			it->second.wall += event.selfWall;
+			it->second.cpu += event.selfCpu;
+			it->second.vertices += event.vertices;
+			it->second.triangles += event.triangles;
+			if(!event.note.empty())
+				notes.push_back(std::make_pair(event.stage, event.note));
+		}
+	}
+
+	const std::ios::fmtflags flags = out.flags();
+	out << std::fixed << std::setprecision(3);
+	out << std::left << std::setw(20) << "stage" << std::right
+			<< std::setw(8) << "calls"
+			<< std::setw(12) << "wall [s]"
+			<< std::setw(12) << "cpu [s]"
+			<< std::setw(14) << "vertices"
+			<< std::setw(14) << "triangles" << "\n";
+	for(auto& stage: stages)
+	{
+		const StageTotals& t = totals[stage];
+		out << std::left << std::setw(20) << stage << std::right
+				<< std::setw(8) << t.calls
+				<< std::setw(12) << t.wall * 1e-6
+				<< std::setw(12) << t.cpu * 1e-6
+				<< std::setw(14) << t.vertices
+				<< std::setw(14) << t.triangles << "\n";
+	}
+	for(auto& note: notes)
+		out << note.first << ": " << note.second << "\n";
+	out << "total wall time "<< (GetWallTime() - mStartWall) * 1e-6 << " s, cpu time " << (GetCpuTime() - mStartCpu) * 1e-6
+			<< " s, peak memory " << GetPeakRss() / (1024 * 1024) << " MiB" << std::endl;
+	out.flags(flags);
+}
+
+/// Write string as JSON string literal
+static void WriteJsonString(std::ostream& out, const std::string& text)
+{
+	out << '"';
+	for(char c: text)
+	{
+		if(c == '"' || c == '\\')
+			out << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+			out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+		else
+			out << c;
+	}
+	out << '"';
+}
+
+void PipelineStats::WriteTrace(const std::string& fileName) const
+{
+	std::ofstream out(fileName);
+	if(!out)
+		throw std::runtime_error("Cannot write " + fileName);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	std::map<std::thread::id, unsigned int> threadNumbers;
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+	for(auto& event: mEvents)
+	{
+		const unsigned int tid = threadNumbers.emplace(event.thread, threadNumbers.size()).first->second;
+		if(!first)
+			out << ",\n";
+		first = false;
+		out << "{\"name\":";
+		WriteJsonString(out, event.stage);
+		out << ",\"cat\":\"compiler\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+				<< ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+				<< ",\"args\":{\"cpu_us\":" << event.selfCpu;
+		if(!event.detail.empty())
+		{
+			out << ",\"detail\":";
+			WriteJsonString(out, event.detail);
+		}
+		if(event.vertices || event.triangles)
+			out << ",\"vertices\":" << event.vertices << ",\"triangles\":" << event.triangles;
+		if(!event.note.empty())
+		{
+			out << ",\"note\":";
+			WriteJsonString(out, event.note);
+		}
+		out << "}},\n";
+
+		// Memory as counter track:
+		out << "{\"name\":\"peak RSS\",\"ph\":\"C\",\"pid\":1,\"ts\":" << event.start + event.duration
+				<< ",\"args\":{\"MiB\":" << event.peakRss / (1024 * 1024) << "}}";
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	if(!out)
+		throw std::runtime_error("Cannot write " + fileName);
+}
+
+uint64_t PipelineStats::GetPeakRss()
+{
+	rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss; // Bytes
+#else
+	return uint64_t(usage.ru_maxrss) * 1024; // Kilobytes
+#endif
+}
+
+uint64_t PipelineStats::GetWallTime()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t PipelineStats::GetCpuTime()
+{
+	timespec time;
+	if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+		return 0;
+	return uint64_t(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+}
+
+void PipelineStats::Add(const Event& event)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mEvents.push_back(event);
+}
+
+} // namespace molecular
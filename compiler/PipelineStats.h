@@ -0,0 +1,122 @@
+/*	PipelineStats.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_PIPELINESTATS_H
+#define MOLECULAR_PIPELINESTATS_H
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace molecular
+{
+
+/// Wall time, CPU time, memory and mesh sizes of compiler stages
+/** Stages are recorded with Scope objects and may be nested. The summary reports the time of each stage without the
+	time of stages nested in it, the trace keeps the nesting. Recording is thread safe. */
+class PipelineStats
+{
+public:
+	/// Records one execution of a stage from construction to destruction
+	class Scope
+	{
+	public:
+		/// @param stats Where to record, nothing is recorded if nullptr.
+		/// @param stage Stage name, must outlive stats.
+		/// @param detail Additional information for the trace, e.g. the file name.
+		Scope(PipelineStats* stats, const char* stage, const std::string& detail = std::string());
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		/// Size of the mesh after this stage
+		void SetCounts(size_t vertices, size_t triangles);
+
+		/// Result of this stage, e.g. quality metrics, listed after the summary and added to the trace
+		void SetNote(const std::string& note);
+
+	private:
+		PipelineStats* mStats;
+		const char* mStage;
+		std::string mDetail;
+		Scope* mParent;
+		uint64_t mStartWall;
+		uint64_t mStartCpu;
+		uint64_t mChildWall = 0;
+		uint64_t mChildCpu = 0;
+		size_t mVertices = 0;
+		size_t mTriangles = 0;
+		std::string mNote;
+	};
+
+	PipelineStats();
+
+	/// Print time, CPU time and mesh sizes per stage, then notes in order of completion, totals and peak memory
+	void PrintSummary(std::ostream& out) const;
+
+	/// Write trace in Chrome trace event format, viewable in chrome://tracing or Perfetto
+	void WriteTrace(const std::string& fileName) const;
+
+	/// Peak resident set size of the process in bytes
+	static uint64_t GetPeakRss();
+
+private:
+	struct Event
+	{
+		const char* stage;
+		std::string detail;
+		std::thread::id thread;
+		uint64_t start; ///< Wall time since construction of stats in microseconds
+		uint64_t duration;
+		uint64_t selfWall;
+		uint64_t selfCpu;
+		uint64_t peakRss;
+		size_t vertices;
+		size_t triangles;
+		std::string note;
+	};
+
+	/// Monotonic wall time in microseconds
+	static uint64_t GetWallTime();
+
+	/// CPU time of the process in microseconds
+	/** Includes worker threads of a stage, but also other stages running concurrently. */
+	static uint64_t GetCpuTime();
+
+	void Add(const Event& event);
+
+	uint64_t mStartWall;
+	uint64_t mStartCpu;
+	mutable std::mutex mMutex;
+	std::vector<Event> mEvents;
+};
+
+} // namespace molecular
+
+#endif // MOLECULAR_PIPELINESTATS_H
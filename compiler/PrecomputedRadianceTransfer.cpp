@@ -30,6 +30,10 @@ SOFTWARE.
 #include <Opcode.h>
 #undef for // WTF?
 
+#include <algorithm>
+#include <exception>
+#include <thread>
+
 namespace molecular
 {
 using namespace util;
@@ -78,7 +82,64 @@ void CalculateDiffuseUnshadowed(Mesh& mesh, std::vector<SphericalHarmonics::Samp
 	mesh.RemoveAttribute(VertexAttributeInfo::kNormal);
 }
 
-void CalculateDiffuseShadowed(Mesh& mesh, std::vector<SphericalHarmonics::Sample<3>> samples)
+/// Calculate shadowed transfer coefficients for vertices [begin, end)
+/** Uses its own collider, so this can run concurrently on a shared model. */
+static void CalculateDiffuseShadowedRange(
+		const Opcode::Model& model,
+		const Vector3* positions,
+		const Vector3* normals,
+		const std::vector<SphericalHarmonics::Sample<3>>& samples,
+		unsigned int begin, unsigned int end,
+		Vector3* outPrt0, Vector3* outPrt1, Vector3* outPrt2)
+{
+	// Any hit beyond the epsilon occludes, ignore hits on the surface around the vertex itself:
+	Opcode::RayCollider collider;
+	collider.SetCulling(false);
+	Opcode::SetupShadowFeeler(collider, 0.01f);
+	if(const char* error = collider.ValidateSettings())
+		throw std::runtime_error(std::string("Invalid collider settings: ") + error);
+
+	// All samples of a vertex start at the same point, so they are cast as packets
+	Opcode::RayPacket packet;
+	const SphericalHarmonics::Sample<3>* packetSamples[OPC_PACKET_SIZE];
+
+	for(unsigned int iVertex = begin; iVertex < end; ++iVertex)
+	{
+		Vector3d normal(normals[iVertex][0], normals[iVertex][1], normals[iVertex][2]);
+		IceMaths::Point origin(positions[iVertex]);
+		Vector<9, double> coeff;
+
+		auto castPacket = [&]()
+		{
+			udword hits = 0;
+			collider.CollidePacket(packet, model, hits);
+			for(udword i = 0; i < packet.GetNbRays(); ++i)
+			{
+				if(!(hits & (1 << i)))
+					coeff += packetSamples[i]->coeff; // No hit found
+			}
+			packet.Reset();
+		};
+
+		for(auto& sample: samples)
+		{
+			if(normal.DotProduct(sample.vec) < 0)
+				continue;
+			packetSamples[packet.GetNbRays()] = &sample;
+			packet.AddRay(origin, IceMaths::Point(sample.vec[0], sample.vec[1], sample.vec[2]));
+			if(packet.IsFull())
+				castPacket();
+		}
+		if(packet.GetNbRays() > 0)
+			castPacket();
+		coeff *= 4.0 * 3.1415926535897932384626433832795029 / samples.size();
+		outPrt0[iVertex] = Vector3(coeff[0], coeff[1], coeff[2]);
+		outPrt1[iVertex] = Vector3(coeff[3], coeff[4], coeff[5]);
+		outPrt2[iVertex] = Vector3(coeff[6], coeff[7], coeff[8]);
+	}
+}
+
+void CalculateDiffuseShadowed(Mesh& mesh, std::vector<SphericalHarmonics::Sample<3>> samples, unsigned int numThreads)
 {
 	const Vector3* normals = nullptr;
 	try
@@ -103,59 +164,59 @@ void CalculateDiffuseShadowed(Mesh& mesh, std::vector<SphericalHarmonics::Sample
 	if(!meshInterface.SetPointers(tris, vertices))
 		throw std::runtime_error("Could not set mesh interface pointers");
 
+	if(numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
 	Opcode::OPCODECREATE create;
 	create.mIMesh = &meshInterface;
+	create.mSettings.mRules = Opcode::SPLIT_SAH; // Tree is only used for ray casts
+	create.mSettings.mNbThreads = numThreads;
 
 	Opcode::Model model;
 	if(!model.Build(create))
 		throw std::runtime_error("Could not build model");
 
-	Opcode::CollisionFaces collisionFaces;
-
-	Opcode::RayCollider collider;
-	collider.SetCulling(false);
-	collider.SetClosestHit(false);
-	collider.SetDestination(&collisionFaces);
-	if(const char* error = collider.ValidateSettings())
-		throw std::runtime_error(std::string("Invalid collider settings: ") + error);
-
-	std::vector<Vector3> outPrt0, outPrt1, outPrt2;
-	outPrt0.reserve(numVertices);
-	outPrt1.reserve(numVertices);
-	outPrt2.reserve(numVertices);
+	std::vector<Vector3> outPrt0(numVertices), outPrt1(numVertices), outPrt2(numVertices);
 	const Vector3* positions = mesh.GetAttribute(VertexAttributeInfo::kPosition).GetData<Vector3>();
-	for(unsigned int iVertex = 0; iVertex < numVertices; ++iVertex)
+
+	numThreads = std::min(numThreads, std::max(numVertices, 1u));
+	if(numThreads == 1)
 	{
-		Vector3d normal(normals[iVertex][0], normals[iVertex][1], normals[iVertex][2]);
-		Vector<9, double> coeff;
-		for(auto& sample: samples)
+		CalculateDiffuseShadowedRange(model, positions, normals, samples, 0, numVertices,
+				outPrt0.data(), outPrt1.data(), outPrt2.data());
+	}
+	else
+	{
+		// Each thread writes a contiguous range of vertices. Results only depend
+		// on the vertex, so output is identical to the single threaded case.
+		std::vector<std::thread> threads;
+		std::vector<std::exception_ptr> exceptions(numThreads);
+		for(unsigned int t = 0; t < numThreads; ++t)
 		{
-			if(normal.DotProduct(sample.vec) < 0)
-				continue;
-			IceMaths::Point origin(positions[iVertex]);
-			IceMaths::Point direction(sample.vec[0], sample.vec[1], sample.vec[2]);
-			IceMaths::Ray ray(origin, direction);
-			collider.Collide(ray, model);
-
-			auto faces = collisionFaces.GetFaces();
-			bool hit = false;
-			for(unsigned int iCols = 0; iCols < collisionFaces.GetNbFaces(); ++iCols)
+			const unsigned int begin = uint64_t(numVertices) * t / numThreads;
+			const unsigned int end = uint64_t(numVertices) * (t + 1) / numThreads;
+			threads.emplace_back([&, t, begin, end]()
 			{
-				if(faces[iCols].mDistance > 0.01)
+				try
 				{
-					hit = true;
-					break;
+					CalculateDiffuseShadowedRange(model, positions, normals, samples, begin, end,
+							outPrt0.data(), outPrt1.data(), outPrt2.data());
 				}
-			}
-			if(!hit)
-				coeff += sample.coeff; // No hit found
-			collisionFaces.Reset();
+				catch(...)
+				{
+					exceptions[t] = std::current_exception();
+				}
+			});
+		}
+		for(auto& thread: threads)
+			thread.join();
+		for(auto& exception: exceptions)
+		{
+			if(exception)
+				std::rethrow_exception(exception);
 		}
-		coeff *= 4.0 * 3.1415926535897932384626433832795029 / samples.size();
-		outPrt0.emplace_back(coeff[0], coeff[1], coeff[2]);
-		outPrt1.emplace_back(coeff[3], coeff[4], coeff[5]);
-		outPrt2.emplace_back(coeff[6], coeff[7], coeff[8]);
 	}
+
 	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt0, outPrt0.data(), numVertices);
 	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt1, outPrt1.data(), numVertices);
 	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt2, outPrt2.data(), numVertices);
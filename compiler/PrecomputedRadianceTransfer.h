@@ -40,7 +40,11 @@ namespace PrecomputedRadianceTransfer
 {
 
 void CalculateDiffuseUnshadowed(util::Mesh& mesh, std::vector<util::SphericalHarmonics::Sample<3>> samples = util::SphericalHarmonics::SetupSphericalSamples<3>());
-void CalculateDiffuseShadowed(util::Mesh& mesh, std::vector<util::SphericalHarmonics::Sample<3>> samples = util::SphericalHarmonics::SetupSphericalSamples<3>());
+
+/// Calculate transfer coefficients with self-shadowing by ray casting
+/** @param numThreads Number of worker threads, 0 for one per hardware thread.
+		Results do not depend on the number of threads. */
+void CalculateDiffuseShadowed(util::Mesh& mesh, std::vector<util::SphericalHarmonics::Sample<3>> samples = util::SphericalHarmonics::SetupSphericalSamples<3>(), unsigned int numThreads = 1);
 }
 
 }
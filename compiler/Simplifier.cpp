@@ -0,0 +1,423 @@
+/*	Simplifier.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Simplifier.h"
+#include <molecular/util/Mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+namespace molecular
+{
+using namespace util;
+
+namespace Simplifier
+{
+
+static const uint32_t kInvalid = std::numeric_limits<uint32_t>::max();
+
+/// Symmetric 4x4 matrix summing squared distances to a set of planes
+class Quadric
+{
+public:
+	void AddPlane(const double n[3], double d)
+	{
+		const double p[4] = {n[0], n[1], n[2], d};
+		int k = 0;
+		for(int i = 0; i < 4; ++i)
+		{
+			for(int j = i; j < 4; ++j)
+				mA[k++] += p[i] * p[j];
+		}
+	}
+
+	void Add(const Quadric& other)
+	{
+		for(int k = 0; k < 10; ++k)
+			mA[k] += other.mA[k];
+	}
+
+	/// Sum of squared distances of point from the planes
+	double Evaluate(const Vector3& point) const
+	{
+		const double p[4] = {point[0], point[1], point[2], 1.0};
+		double sum = 0.0;
+		int k = 0;
+		for(int i = 0; i < 4; ++i)
+		{
+			for(int j = i; j < 4; ++j)
+				sum += (i == j ? 1.0 : 2.0) * mA[k++] * p[i] * p[j];
+		}
+		return std::max(sum, 0.0);
+	}
+
+private:
+	double mA[10] = {0};
+};
+
+/// Cross product of the edges of a triangle, not normalized
+static void GetNormal(const Vector3& a, const Vector3& b, const Vector3& c, double outNormal[3])
+{
+	const double u[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+	const double v[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+	outNormal[0] = u[1] * v[2] - u[2] * v[1];
+	outNormal[1] = u[2] * v[0] - u[0] * v[2];
+	outNormal[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+/// Map every vertex to the lowest vertex with the same position
+static std::vector<uint32_t> WeldPositions(const Vector3* positions, size_t numVertices)
+{
+	// Compare bit patterns, -0 and +0 count as the same position:
+	auto key = [positions](uint32_t v)
+	{
+		uint32_t bits[3];
+		for(int i = 0; i < 3; ++i)
+		{
+			const float coordinate = positions[v][i] + 0.0f;
+			memcpy(&bits[i], &coordinate, sizeof(float));
+		}
+		return std::make_tuple(bits[0], bits[1], bits[2]);
+	};
+
+	std::vector<uint32_t> order(numVertices);
+	for(size_t i = 0; i < numVertices; ++i)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&key](uint32_t a, uint32_t b){
+		const auto keyA = key(a), keyB = key(b);
+		return keyA < keyB || (keyA == keyB && a < b);
+	});
+
+	std::vector<uint32_t> remap(numVertices);
+	for(size_t i = 0; i < numVertices; ++i)
+		remap[order[i]] = (i > 0 && key(order[i]) == key(order[i - 1])) ? remap[order[i - 1]] : order[i];
+	return remap;
+}
+
+/// Triangles around each position, rebuilt after every pass
+struct Adjacency
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+
+	void Build(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap)
+	{
+		offsets.assign(remap.size() + 1, 0);
+		for(uint32_t index: indices)
+			offsets[remap[index] + 1]++;
+		for(size_t i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i - 1];
+
+		triangles.resize(indices.size());
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for(size_t i = 0; i < indices.size(); ++i)
+			triangles[fill[remap[indices[i]]]++] = i / 3;
+	}
+
+	const uint32_t* begin(uint32_t position) const {return triangles.data() + offsets[position];}
+	const uint32_t* end(uint32_t position) const {return triangles.data() + offsets[position + 1];}
+};
+
+/// Candidate collapse of vertex from onto vertex to
+struct Collapse
+{
+	double cost;
+	uint32_t from;
+	uint32_t to;
+
+	bool operator<(const Collapse& other) const {return cost < other.cost;}
+};
+
+std::vector<uint32_t> Simplify(const uint32_t* indices, size_t numIndices,
+		const Vector3* positions, size_t numVertices,
+		size_t targetIndexCount, float& outError,
+		const uint32_t* vertexClasses)
+{
+	outError = 0.0f;
+	const std::vector<uint32_t> remap = WeldPositions(positions, numVertices);
+
+	// Triangles that are degenerate by position cannot be seen:
+	std::vector<uint32_t> result;
+	result.reserve(numIndices);
+	for(size_t i = 0; i + 2 < numIndices; i += 3)
+	{
+		const uint32_t* tri = indices + i;
+		for(int k = 0; k < 3; ++k)
+		{
+			if(tri[k] >= numVertices)
+				throw std::runtime_error("Index out of range");
+		}
+		const uint32_t a = remap[tri[0]], b = remap[tri[1]], c = remap[tri[2]];
+		if(a != b && b != c && c != a)
+			result.insert(result.end(), tri, tri + 3);
+	}
+
+	std::vector<Quadric> quadrics(numVertices);
+	for(size_t i = 0; i < result.size(); i += 3)
+	{
+		const uint32_t* tri = result.data() + i;
+		double normal[3];
+		GetNormal(positions[tri[0]], positions[tri[1]], positions[tri[2]], normal);
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if(!(length > 0.0))
+			continue;
+		for(int k = 0; k < 3; ++k)
+			normal[k] /= length;
+		const double d = -(normal[0] * positions[tri[0]][0] + normal[1] * positions[tri[0]][1] + normal[2] * positions[tri[0]][2]);
+		for(int k = 0; k < 3; ++k)
+			quadrics[tri[k]].AddPlane(normal, d);
+	}
+
+	// Lock seams, which have several vertices at one position, and edges without exactly one opposite edge:
+	std::vector<bool> locked(numVertices, false);
+	for(size_t v = 0; v < numVertices; ++v)
+	{
+		if(remap[v] != v)
+			locked[v] = locked[remap[v]] = true;
+	}
+	std::unordered_map<uint64_t, uint32_t> edgeCounts;
+	auto edgeKey = [](uint32_t a, uint32_t b){return (uint64_t(a) << 32) | b;};
+	for(size_t i = 0; i < result.size(); i += 3)
+	{
+		for(int k = 0; k < 3; ++k)
+			edgeCounts[edgeKey(remap[result[i + k]], remap[result[i + (k + 1) % 3]])]++;
+	}
+	for(auto& edge: edgeCounts)
+	{
+		const uint32_t a = edge.first >> 32, b = edge.first & 0xffffffff;
+		auto opposite = edgeCounts.find(edgeKey(b, a));
+		if(edge.second != 1 || opposite == edgeCounts.end() || opposite->second != 1)
+			locked[a] = locked[b] = true;
+	}
+	for(size_t v = 0; v < numVertices; ++v)
+		locked[v] = locked[v] || locked[remap[v]];
+
+	Adjacency adjacency;
+	std::vector<uint32_t> collapseTo(numVertices, kInvalid);
+	std::vector<bool> touched(numVertices);
+	std::vector<uint32_t> ring, otherRing;
+	std::vector<Collapse> candidates;
+	double maxCost = 0.0;
+
+	// Positions around vertex, or false if a neighbor position is referenced through different vertices:
+	auto getRing = [&](uint32_t position, std::vector<uint32_t>& outRing, std::vector<uint32_t>* outNeighbors)
+	{
+		outRing.clear();
+		if(outNeighbors)
+			outNeighbors->clear();
+		for(const uint32_t* t = adjacency.begin(position); t != adjacency.end(position); ++t)
+		{
+			for(int k = 0; k < 3; ++k)
+			{
+				const uint32_t neighbor = result[*t * 3 + k];
+				if(remap[neighbor] == position)
+					continue;
+				auto it = std::find(outRing.begin(), outRing.end(), remap[neighbor]);
+				if(it == outRing.end())
+				{
+					outRing.push_back(remap[neighbor]);
+					if(outNeighbors)
+						outNeighbors->push_back(neighbor);
+				}
+				else if(outNeighbors && (*outNeighbors)[it - outRing.begin()] != neighbor)
+					return false;
+			}
+		}
+		return true;
+	};
+
+	std::vector<uint32_t> neighbors;
+	while(result.size() > targetIndexCount)
+	{
+		adjacency.Build(result, remap);
+
+		// Cheapest collapse of each removable vertex:
+		candidates.clear();
+		for(uint32_t u = 0; u < numVertices; ++u)
+		{
+			if(locked[u] || adjacency.begin(u) == adjacency.end(u))
+				continue;
+			if(!getRing(u, ring, &neighbors))
+			{
+				// Next to a seam from both sides, moving it would stretch attributes across the seam
+				locked[u] = true;
+				continue;
+			}
+
+			Collapse best = {std::numeric_limits<double>::max(), u, kInvalid};
+			for(uint32_t v: neighbors)
+			{
+				if(vertexClasses && vertexClasses[u] != vertexClasses[v])
+					continue;
+				const double cost = quadrics[u].Evaluate(positions[v]);
+				if(cost < best.cost)
+					best = {cost, u, v};
+			}
+			if(best.to != kInvalid)
+				candidates.push_back(best);
+		}
+		if(candidates.empty())
+			break;
+		std::sort(candidates.begin(), candidates.end());
+
+		// Apply the cheapest independent collapses. An interior collapse removes two triangles:
+		const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+		const size_t maxCandidates = std::max<size_t>(1, (candidates.size() + 2) / 3);
+		size_t trianglesRemoved = 0;
+		std::fill(touched.begin(), touched.end(), false);
+		for(size_t c = 0; c < candidates.size() && c < maxCandidates && trianglesRemoved < trianglesToRemove; ++c)
+		{
+			const uint32_t u = candidates[c].from, v = candidates[c].to;
+			if(touched[u] || touched[remap[v]])
+				continue;
+
+			// Positions adjacent to both must be exactly the third corners of the triangles on edge u-v:
+			getRing(u, ring, nullptr);
+			getRing(remap[v], otherRing, nullptr);
+			unsigned int numShared = 0;
+			for(uint32_t position: ring)
+				numShared += std::count(otherRing.begin(), otherRing.end(), position);
+			unsigned int numEdgeTriangles = 0;
+			bool flipped = false;
+			for(const uint32_t* t = adjacency.begin(u); t != adjacency.end(u); ++t)
+			{
+				const uint32_t* tri = result.data() + *t * 3;
+				if(remap[tri[0]] == remap[v] || remap[tri[1]] == remap[v] || remap[tri[2]] == remap[v])
+				{
+					numEdgeTriangles++;
+					continue;
+				}
+
+				// Remaining triangles must not turn over:
+				Vector3 moved[3] = {positions[tri[0]], positions[tri[1]], positions[tri[2]]};
+				for(int k = 0; k < 3; ++k)
+				{
+					if(tri[k] == u)
+						moved[k] = positions[v];
+				}
+				double before[3], after[3];
+				GetNormal(positions[tri[0]], positions[tri[1]], positions[tri[2]], before);
+				GetNormal(moved[0], moved[1], moved[2], after);
+				const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+						* (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+				if(!(dot > 1e-2 * lengths))
+				{
+					flipped = true;
+					break;
+				}
+			}
+			if(flipped || numShared != numEdgeTriangles)
+				continue;
+
+			// Keep the neighborhood unchanged for the rest of this pass:
+			touched[u] = touched[remap[v]] = true;
+			for(uint32_t position: ring)
+				touched[position] = true;
+
+			collapseTo[u] = v;
+			quadrics[v].Add(quadrics[u]);
+			maxCost = std::max(maxCost, candidates[c].cost);
+			trianglesRemoved += numEdgeTriangles;
+		}
+		if(trianglesRemoved == 0)
+			break;
+
+		// Move collapsed vertices and drop triangles that became degenerate:
+		size_t write = 0;
+		for(size_t i = 0; i < result.size(); i += 3)
+		{
+			uint32_t tri[3];
+			for(int k = 0; k < 3; ++k)
+			{
+				tri[k] = result[i + k];
+				if(collapseTo[tri[k]] != kInvalid)
+					tri[k] = collapseTo[tri[k]];
+			}
+			if(remap[tri[0]] == remap[tri[1]] || remap[tri[1]] == remap[tri[2]] || remap[tri[2]] == remap[tri[0]])
+				continue;
+			for(int k = 0; k < 3; ++k)
+				result[write++] = tri[k];
+		}
+		result.resize(write);
+		for(uint32_t u = 0; u < numVertices; ++u)
+		{
+			if(collapseTo[u] != kInvalid)
+			{
+				collapseTo[u] = kInvalid;
+				locked[u] = true; // No longer referenced
+			}
+		}
+	}
+
+	outError = std::sqrt(maxCost);
+	return result;
+}
+
+std::vector<uint32_t> Simplify(const Mesh& mesh, size_t targetIndexCount, float& outError)
+{
+	outError = 0.0f;
+	auto& indices = mesh.GetIndices();
+	if(mesh.GetMode() != IndexBufferInfo::Mode::kTriangles)
+		return indices;
+
+	auto& position = mesh.GetAttribute(VertexAttributeInfo::kPosition);
+	if(position.GetType() != VertexAttributeInfo::kFloat || position.GetNumComponents() != 3)
+		throw std::runtime_error("Simplification needs positions with three 32 bit float components");
+
+	// Most influential joint of each vertex:
+	const size_t numVertices = mesh.GetNumVertices();
+	std::vector<uint32_t> classes;
+	auto& attributes = mesh.GetAttributes();
+	if(attributes.count(VertexAttributeInfo::kSkinWeights) && attributes.count("vertexSkinJointsAttr"_H))
+	{
+		auto& weights = mesh.GetAttribute(VertexAttributeInfo::kSkinWeights);
+		auto& joints = mesh.GetAttribute("vertexSkinJointsAttr"_H);
+		if(weights.GetType() != VertexAttributeInfo::kFloat || weights.GetNumComponents() != 4
+				|| joints.GetRawSize() != numVertices * 4 * sizeof(int32_t))
+			throw std::runtime_error("Simplification needs four 32 bit skin weights and joints per vertex");
+
+		const float* vertexWeights = static_cast<const float*>(weights.GetRawData());
+		const int32_t* vertexJoints = static_cast<const int32_t*>(joints.GetRawData());
+		classes.resize(numVertices);
+		for(size_t v = 0; v < numVertices; ++v)
+		{
+			const float* w = vertexWeights + v * 4;
+			classes[v] = vertexJoints[v * 4 + (std::max_element(w, w + 4) - w)];
+		}
+	}
+
+	return Simplify(indices.data(), indices.size(), position.GetData<Vector3>(), numVertices,
+			targetIndexCount, outError, classes.empty() ? nullptr : classes.data());
+}
+
+}
+
+} // namespace molecular
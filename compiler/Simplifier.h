@@ -0,0 +1,70 @@
+/*	Simplifier.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_SIMPLIFIER_H
+#define MOLECULAR_SIMPLIFIER_H
+
+#include <molecular/util/Vector3.h>
+#include <cstdint>
+#include <vector>
+
+namespace molecular
+{
+
+namespace util
+{
+class Mesh;
+}
+
+/// Triangle count reduction for levels of detail
+/** Uses quadric error metrics (Garland and Heckbert) with half edge collapses: a vertex is removed by moving it onto
+	one of its neighbors. No vertices are created, so simplified index lists can be drawn with the vertex buffers of
+	the original mesh. Vertices on attribute seams (several vertices at the same position, e.g. UV or normal
+	discontinuities) and on open borders are never removed, so seams and silhouettes of open meshes stay intact. */
+namespace Simplifier
+{
+
+/// Remove triangles until at most targetIndexCount indices are left
+/** @param vertexClasses Optional class per vertex. Vertices are only collapsed onto vertices of the same class, e.g.
+		vertices influenced mostly by the same skinning joint. May be nullptr.
+	@param outError Receives the largest estimated distance between the simplified and the original surface.
+	@returns Simplified triangle list referencing the original vertices. Has more than targetIndexCount indices if no
+		more vertices can be removed without changing seams, borders or topology. */
+std::vector<uint32_t> Simplify(const uint32_t* indices, size_t numIndices,
+		const util::Vector3* positions, size_t numVertices,
+		size_t targetIndexCount, float& outError,
+		const uint32_t* vertexClasses = nullptr);
+
+/// Simplify the triangles of a mesh
+/** Vertices are only collapsed onto vertices with the same most influential skinning joint, so that simplified
+	levels deform like the original mesh.
+	@returns Indices of the mesh unchanged if it is not a triangle list. */
+std::vector<uint32_t> Simplify(const util::Mesh& mesh, size_t targetIndexCount, float& outError);
+
+}
+
+} // namespace molecular
+
+#endif // MOLECULAR_SIMPLIFIER_H
@@ -0,0 +1,105 @@
+/*	VertexFetchOptimizer.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "VertexFetchOptimizer.h"
+#include <molecular/util/Mesh.h>
+
+#include <limits>
+#include <stdexcept>
+
+namespace molecular
+{
+using namespace util;
+
+namespace VertexFetchOptimizer
+{
+
+std::vector<uint32_t> Optimize(uint32_t* indices, size_t numIndices, size_t numVertices)
+{
+	const uint32_t kUnused = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(numVertices, kUnused);
+	uint32_t next = 0;
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		const uint32_t index = indices[i];
+		if(index >= numVertices)
+			throw std::runtime_error("Index out of range");
+		if(remap[index] == kUnused)
+			remap[index] = next++;
+		indices[i] = remap[index];
+	}
+
+	for(uint32_t& newIndex: remap)
+	{
+		if(newIndex == kUnused)
+			newIndex = next++;
+	}
+	return remap;
+}
+
+/// Move vertex v of an attribute to remap[v]
+template<typename T>
+static void PermuteAttribute(Mesh& mesh, Hash semantic, const std::vector<uint32_t>& remap)
+{
+	const T* data = mesh.GetAttribute(semantic).GetData<T>();
+	std::vector<T> permuted(remap.size());
+	for(size_t v = 0; v < remap.size(); ++v)
+		permuted[remap[v]] = data[v];
+	mesh.SetAttributeData(semantic, permuted.data(), permuted.size());
+}
+
+std::vector<uint32_t> Optimize(Mesh& mesh)
+{
+	const size_t numVertices = mesh.GetNumVertices();
+	auto& indices = mesh.GetIndices();
+	std::vector<uint32_t> remap = Optimize(indices.data(), indices.size(), numVertices);
+
+	// Collect first, setting attribute data may modify the attribute map:
+	std::vector<Hash> semantics;
+	for(auto& attribute: mesh.GetAttributes())
+		semantics.push_back(attribute.first);
+
+	for(Hash semantic: semantics)
+	{
+		auto& attribute = mesh.GetAttribute(semantic);
+		const size_t elementSize = numVertices ? attribute.GetRawSize() / numVertices : 0;
+		const unsigned int components = attribute.GetNumComponents();
+		if(attribute.GetType() == VertexAttributeInfo::kFloat && components == 2 && elementSize == sizeof(Vector2))
+			PermuteAttribute<Vector2>(mesh, semantic, remap);
+		else if(attribute.GetType() == VertexAttributeInfo::kFloat && components == 3 && elementSize == sizeof(Vector3))
+			PermuteAttribute<Vector3>(mesh, semantic, remap);
+		else if(attribute.GetType() == VertexAttributeInfo::kFloat && components == 4 && elementSize == sizeof(Vector4))
+			PermuteAttribute<Vector4>(mesh, semantic, remap);
+		else if(attribute.GetType() != VertexAttributeInfo::kFloat && components == 4 && elementSize == sizeof(IntVector4))
+			PermuteAttribute<IntVector4>(mesh, semantic, remap);
+		else
+			throw std::runtime_error("Cannot reorder vertices with attributes other than 32 bit vectors");
+	}
+	return remap;
+}
+
+}
+
+} // namespace molecular
@@ -0,0 +1,64 @@
+/*	VertexFetchOptimizer.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_VERTEXFETCHOPTIMIZER_H
+#define MOLECULAR_VERTEXFETCHOPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace molecular
+{
+
+namespace util
+{
+class Mesh;
+}
+
+/// Vertex renumbering for memory locality
+/** After the triangle order has been optimized for the post-transform cache, vertices are still stored in their
+	original order and fetched from scattered locations. Renumbering them in the order the index buffer first uses
+	them makes vertex fetches mostly sequential, and neighboring vertices in memory are usually neighbors on the
+	surface, which also compresses better. */
+namespace VertexFetchOptimizer
+{
+
+/// Renumber vertices in order of first use and rewrite indices in place
+/** Vertices not referenced by indices are kept after all referenced ones, in their previous order.
+	@returns New number of each vertex, to be applied to vertex data and other index lists. */
+std::vector<uint32_t> Optimize(uint32_t* indices, size_t numIndices, size_t numVertices);
+
+/// Renumber the vertices of a mesh in order of first use by its indices
+/** Permutes all attributes. Attributes must still be in the 32 bit types created by the converters, i.e. this has to
+	run before MeshUtils::ReducePrecision.
+	@returns New number of each vertex, e.g. for index lists of levels of detail. */
+std::vector<uint32_t> Optimize(util::Mesh& mesh);
+
+}
+
+} // namespace molecular
+
+#endif // MOLECULAR_VERTEXFETCHOPTIMIZER_H
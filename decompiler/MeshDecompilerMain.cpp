@@ -23,12 +23,18 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "compiler/MeshAnalysis.h"
 #include <molecular/meshfile/MeshFile.h>
-#include <molecular/util/Blob.h>
+#include <molecular/meshfile/MeshFileView.h>
 #include <molecular/util/CommandLineParser.h>
-#include <molecular/util/FileStreamStorage.h>
 #include <molecular/util/StringUtils.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+
 using namespace molecular;
 using namespace molecular::util;
 using namespace molecular::meshfile;
@@ -47,59 +53,272 @@ void PrintTriangleIndices(const void* data, uint32_t count)
 
 }
 
+/// Widen indices of any type to 32 bit
+template<typename T>
+void AppendIndices(const void* data, uint32_t count, std::vector<uint32_t>& out)
+{
+	const T* indexData = static_cast<const T*>(data);
+	out.insert(out.end(), indexData, indexData + count);
+}
+
+std::vector<uint32_t> ReadIndices(const MeshFileView& mesh, const IndexBufferInfo& info)
+{
+	std::vector<uint32_t> indices;
+	indices.reserve(info.count);
+	const void* indexData = mesh.GetBufferData(info.buffer).data() + info.offset;
+	if(info.type == IndexBufferInfo::Type::kUInt8)
+		AppendIndices<uint8_t>(indexData, info.count, indices);
+	else if(info.type == IndexBufferInfo::Type::kUInt16)
+		AppendIndices<uint16_t>(indexData, info.count, indices);
+	else if(info.type == IndexBufferInfo::Type::kUInt32)
+		AppendIndices<uint32_t>(indexData, info.count, indices);
+	return indices;
+}
+
+/// Size of one vertex attribute element in bytes
+size_t GetElementSize(const VertexAttributeInfo& info)
+{
+	return MeshFileView::GetComponentSize(info.type) * info.components;
+}
+
+/// Convert IEEE 754 half precision number to float
+float HalfToFloat(uint16_t half)
+{
+	const uint32_t sign = uint32_t(half & 0x8000) << 16;
+	const uint32_t exponent = (half >> 10) & 0x1f;
+	const uint32_t mantissa = half & 0x3ff;
+	uint32_t bits;
+	if(exponent == 0x1f) // Infinity or NaN
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	else if(exponent != 0)
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	else // Zero or subnormal, exactly representable as float
+	{
+		const float value = std::ldexp(float(mantissa), -24);
+		return sign ? -value : value;
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+/// Read integer component, normalized to [0, 1] or [-1, 1] as by glVertexAttribPointer
+template<typename T>
+float IntegerToFloat(const uint8_t* data, bool normalized)
+{
+	T value;
+	memcpy(&value, data, sizeof(value));
+	if(!normalized)
+		return float(value);
+	return std::max(float(value) / float(std::numeric_limits<T>::max()), -1.0f);
+}
+
+/// Convert one component of the given type to float
+float ComponentToFloat(const uint8_t* data, VertexAttributeInfo::Type type, bool normalized)
+{
+	switch(type)
+	{
+	case VertexAttributeInfo::kFloat:
+	{
+		float value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+	case VertexAttributeInfo::kHalf:
+	{
+		uint16_t value;
+		memcpy(&value, data, sizeof(value));
+		return HalfToFloat(value);
+	}
+	case VertexAttributeInfo::kInt8: return IntegerToFloat<int8_t>(data, normalized);
+	case VertexAttributeInfo::kUInt8: return IntegerToFloat<uint8_t>(data, normalized);
+	case VertexAttributeInfo::kInt16: return IntegerToFloat<int16_t>(data, normalized);
+	case VertexAttributeInfo::kUInt16: return IntegerToFloat<uint16_t>(data, normalized);
+	case VertexAttributeInfo::kInt32: return IntegerToFloat<int32_t>(data, normalized);
+	case VertexAttributeInfo::kUInt32: return IntegerToFloat<uint32_t>(data, normalized);
+	}
+	throw std::runtime_error("Unsupported vertex attribute type " + std::to_string(uint32_t(type)));
+}
+
+/// Convert all elements of a vertex attribute to float, components of each vertex one after another
+std::vector<float> ReadAttribute(const MeshFileView& mesh, const VertexAttributeInfo& info, uint32_t numVertices)
+{
+	const size_t componentSize = MeshFileView::GetComponentSize(info.type);
+	const size_t stride = info.stride ? info.stride : componentSize * info.components;
+	const uint8_t* data = mesh.GetBufferData(info.buffer).data() + info.offset;
+
+	std::vector<float> out(size_t(numVertices) * info.components);
+	for(uint32_t vertex = 0; vertex < numVertices; ++vertex)
+	{
+		const uint8_t* element = data + vertex * stride;
+		float* outElement = out.data() + vertex * info.components;
+		for(uint32_t i = 0; i < info.components; ++i)
+			outElement[i] = ComponentToFloat(element + i * componentSize, info.type, info.normalized);
+	}
+	return out;
+}
+
+/// Parse comma separated cache sizes, e.g. "16,32"
+std::vector<unsigned int> ParseCacheSizes(const std::string& list)
+{
+	std::vector<unsigned int> sizes;
+	std::istringstream stream(list);
+	std::string entry;
+	while(std::getline(stream, entry, ','))
+	{
+		if(entry.empty())
+			continue;
+		size_t end = 0;
+		unsigned long size = 0;
+		try
+		{
+			size = std::stoul(entry, &end);
+		}
+		catch(std::exception&)
+		{
+		}
+		if(size == 0 || size > 65536 || end != entry.size())
+			throw std::runtime_error("Invalid cache size \"" + entry + "\"");
+		sizes.push_back(size);
+	}
+	return sizes;
+}
+
+/// Print vertex cache, vertex fetch and overdraw estimates of one index specification
+void AnalyzeIndexSpec(const MeshFileView& mesh, const IndexBufferInfo& info,
+		const std::vector<unsigned int>& fifoSizes, const std::vector<unsigned int>& lruSizes)
+{
+	static const char* const kIndexTypes[] = {"8 bit", "16 bit", "32 bit"};
+	static const char* const kModes[] = {"points", "lines", "triangles", "triangle strip"};
+	const MeshFile::VertexDataSet& dataset = mesh.GetVertexDataSets()[info.vertexDataSet];
+	const unsigned int mode = static_cast<unsigned int>(info.mode);
+
+	std::cout << "  " << (mode < 4 ? kModes[mode] : "unknown mode") << ", "
+			<< kIndexTypes[static_cast<unsigned int>(info.type)] << " indices, " << info.count << " indices, "
+			<< dataset.numVertices << " vertices in vertex data set " << info.vertexDataSet << "\n";
+
+	// Interleaved attributes share a buffer and its stride:
+	std::map<uint32_t, size_t> strides;
+	const VertexAttributeInfo* position = nullptr;
+	for(const VertexAttributeInfo& attribute: mesh.GetVertexSpecs(info.vertexDataSet))
+	{
+		const size_t stride = attribute.stride ? attribute.stride : GetElementSize(attribute);
+		strides[attribute.buffer] = std::max(strides[attribute.buffer], stride);
+		if(attribute.semantic == VertexAttributeInfo::kPosition)
+			position = &attribute;
+	}
+
+	const std::vector<uint32_t> indices = ReadIndices(mesh, info);
+	const bool triangles = info.mode == IndexBufferInfo::Mode::kTriangles;
+	if(triangles)
+	{
+		for(auto policy: {MeshAnalysis::CachePolicy::kFifo, MeshAnalysis::CachePolicy::kLru})
+		{
+			const bool fifo = policy == MeshAnalysis::CachePolicy::kFifo;
+			for(unsigned int cacheSize: fifo ? fifoSizes : lruSizes)
+			{
+				const auto statistics = MeshAnalysis::AnalyzeVertexCache(indices.data(), indices.size(), dataset.numVertices, cacheSize, policy);
+				std::cout << "  " << (fifo ? "FIFO " : "LRU ") << cacheSize << ": ACMR " << statistics.acmr
+						<< ", ATVR " << statistics.atvr << "\n";
+			}
+		}
+	}
+
+	for(auto& buffer: strides)
+	{
+		std::cout << "  buffer " << buffer.first << ": " << buffer.second << " bytes per vertex";
+		if(triangles)
+			std::cout << ", overfetch " << MeshAnalysis::CalculateOverfetch(indices.data(), indices.size(), dataset.numVertices, buffer.second);
+		std::cout << "\n";
+	}
+
+	if(!triangles)
+		return;
+	if(!position || position->type != VertexAttributeInfo::kFloat || position->components < 3)
+	{
+		std::cout << "  overdraw: needs 32 bit float positions\n";
+		return;
+	}
+	const size_t stride = position->stride ? position->stride : GetElementSize(*position);
+	const uint8_t* data = mesh.GetBufferData(position->buffer).data() + position->offset;
+	std::vector<Vector3> positions(dataset.numVertices);
+	for(uint32_t vertex = 0; vertex < dataset.numVertices; ++vertex)
+	{
+		float p[3];
+		memcpy(p, data + vertex * stride, sizeof(p));
+		positions[vertex] = Vector3(p[0], p[1], p[2]);
+	}
+	std::cout << "  overdraw " << MeshAnalysis::EstimateOverdraw(indices.data(), indices.size(), positions.data(), positions.size()) << "\n";
+}
+
+/// Print analysis of all index specifications, including levels of detail
+void Analyze(const MeshFileView& mesh, const std::vector<unsigned int>& fifoSizes, const std::vector<unsigned int>& lruSizes)
+{
+	std::cout.precision(3);
+	const auto indexSpecs = mesh.GetIndexSpecs();
+	for(size_t i = 0; i < indexSpecs.size(); ++i)
+	{
+		const IndexBufferInfo& info = indexSpecs[i];
+		std::cout << "index spec " << i << " (" << std::string(info.material, strnlen(info.material, sizeof(info.material))) << "):\n";
+		AnalyzeIndexSpec(mesh, info, fifoSizes, lruSizes);
+	}
+
+	const auto lods = mesh.GetLods();
+	const auto lodIndexSpecs = mesh.GetLodIndexSpecs();
+	for(size_t i = 0; i < lods.size(); ++i)
+	{
+		std::cout << "index spec " << lods[i].indexSpec << " level of detail " << lods[i].level
+				<< " (error " << lods[i].error << "):\n";
+		AnalyzeIndexSpec(mesh, lodIndexSpecs[i], fifoSizes, lruSizes);
+	}
+}
+
 int main(int argc, char** argv)
 {
 	CommandLineParser cmd;
 	CommandLineParser::PositionalArg<std::string> inFileName(cmd, "input file", "Input mesh to decompile");
+	CommandLineParser::Flag analyze(cmd, "analyze", "Print cache, vertex fetch and overdraw estimates of every index specification instead of OBJ text");
+	CommandLineParser::Option<std::string> fifo(cmd, "fifo", "Comma separated FIFO vertex cache sizes for --analyze", "16,32");
+	CommandLineParser::Option<std::string> lru(cmd, "lru", "Comma separated LRU vertex cache sizes for --analyze", "16,32");
 	CommandLineParser::HelpFlag help(cmd);
 
 	try
 	{
 		cmd.Parse(argc, argv);
 
-		FileReadStorage inFile(*inFileName);
-		Blob inData(inFile.GetSize());
-		inFile.Read(inData.GetData(), inData.GetSize());
-		const MeshFile* inMesh = static_cast<const MeshFile*>(inData.GetData());
-		if(inMesh->magic != MeshFile::kMagic)
-			throw std::runtime_error("Unrecognized input file type");
+		const MappedMeshFile inFile = MapMeshFile(*inFileName);
+		const MeshFileView& inMesh = inFile.GetView();
+		if(inMesh.GetVertexDataSets().empty() || inMesh.GetIndexSpecs().empty())
+			throw std::runtime_error("Input file contains no mesh");
+
+		if(analyze)
+		{
+			Analyze(inMesh, ParseCacheSizes(*fifo), ParseCacheSizes(*lru));
+			return EXIT_SUCCESS;
+		}
 
 		std::cout << "# Created by molecularmeshdecompiler\n";
 		std::cout << "o " << *inFileName << "\n";
 
-		const MeshFile::VertexDataSet& dataset = inMesh->GetVertexDataSet(0);
-		for(uint32_t v = 0; v < dataset.numVertexSpecs; ++v)
+		const MeshFile::VertexDataSet& dataset = inMesh.GetVertexDataSets()[0];
+		for(const VertexAttributeInfo& info: inMesh.GetVertexSpecs(0))
 		{
-			const VertexAttributeInfo& info = inMesh->GetVertexSpec(0, v);
-			const MeshFile::Buffer& buffer = inMesh->GetBuffer(info.buffer);
 
-			std::vector<float> toFloatData;
-			if(info.type == VertexAttributeInfo::kHalf)
-			{
-				toFloatData.resize(buffer.size / 2); // TODO: Interleaved buffer, strides etc.
-#if defined(__ARM_FP16_FORMAT_IEEE) || defined(__STDCPP_FLOAT16_T__)
-				const __fp16* f = static_cast<const __fp16*>(inMesh->GetBufferData(info.buffer));
-				for(size_t i = 0; i < buffer.size / 2; ++i)
-					toFloatData[i] = f[i];
-#else
-				// TODO
-#endif
-			}
+			const char* prefix = nullptr;
+			if(info.semantic == VertexAttributeInfo::kTextureCoords)
+				prefix = "vt";
+			else if(info.semantic == VertexAttributeInfo::kPosition)
+				prefix = "v";
+			else if(info.semantic == VertexAttributeInfo::kNormal)
+				prefix = "vn";
 			else
-			{
-				toFloatData.resize(buffer.size / 4); // TODO: Interleaved buffer, strides etc.
-				memcpy(toFloatData.data(), inMesh->GetBufferData(info.buffer), buffer.size);
-			}
+				continue;
 
-			for(int pos = 0; pos < toFloatData.size(); pos += info.components)
-			{
-				if(info.semantic == VertexAttributeInfo::kTextureCoords)
-					std::cout << "vt";
-				else if(info.semantic == VertexAttributeInfo::kPosition)
-					std::cout << "v";
-				else if(info.semantic == VertexAttributeInfo::kNormal)
-					std::cout << "vn";
+			const std::vector<float> toFloatData = ReadAttribute(inMesh, info, dataset.numVertices);
 
+			for(size_t pos = 0; pos < toFloatData.size(); pos += info.components)
+			{
+				std::cout << prefix;
 				for(int i = 0; i < info.components; ++i)
 					std::cout << " " << toFloatData[pos + i];
 				std::cout << "\n";
@@ -108,8 +327,8 @@ int main(int argc, char** argv)
 
 		std::cout << "s off\n";
 
-		const IndexBufferInfo& indexInfo = inMesh->GetIndexSpec(0);
-		const void* indexData = inMesh->GetBufferData(indexInfo.buffer);
+		const IndexBufferInfo& indexInfo = inMesh.GetIndexSpecs()[0];
+		const void* indexData = inMesh.GetBufferData(indexInfo.buffer).data() + indexInfo.offset;
 		if(indexInfo.type == IndexBufferInfo::Type::kUInt8)
 			PrintTriangleIndices<uint8_t>(indexData, indexInfo.count);
 		else if(indexInfo.type == IndexBufferInfo::Type::kUInt16)
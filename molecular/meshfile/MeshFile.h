@@ -66,12 +66,54 @@ struct MeshFile
 	};
 	static_assert(sizeof(VertexDataSet) == 16, "VertexDataSet struct not aligned correctly");
 
+	/// Meshlets of one index specification
+	struct MeshletSet
+	{
+		uint32_t numMeshlets;
+		uint32_t meshletsOffset; ///< Byte offset inside file to meshlets @see Meshlet
+		uint32_t maxVertices; ///< Largest vertex count of the meshlets, e.g. for sizing mesh shader outputs
+		uint32_t maxTriangles; ///< Largest triangle count of the meshlets
+	};
+	static_assert(sizeof(MeshletSet) == 16, "MeshletSet struct not aligned correctly");
+
+	/// Cluster of neighboring triangles with bounds for culling
+	/** The triangles of a meshlet are a contiguous range of the indices of its index specification. The meshlet can be
+		skipped if its bounding sphere is outside the view frustum. All of its triangles face away from a camera at
+		position c if dot(d, coneAxis) >= coneCutoff * length(d) + radius * (1 + coneCutoff), with d = center - c. */
+	struct Meshlet
+	{
+		float center[3]; ///< Bounding sphere center
+		float radius; ///< Bounding sphere radius
+		float coneAxis[3]; ///< Normalized average direction of the triangle normals
+		float coneCutoff; ///< Sine of the half angle of the cone containing all triangle normals, 1 if it is 90 degrees or more
+		uint32_t indexOffset; ///< First index of the meshlet, in indices (not bytes) after the byte offset IndexBufferInfo::offset
+		uint32_t indexCount; ///< Number of indices, three per triangle
+		uint32_t vertexCount; ///< Number of distinct vertices referenced
+		uint32_t reserved;
+	};
+	static_assert(sizeof(Meshlet) == 48, "Meshlet struct not aligned correctly");
+
+	/// Simplified version of the triangles of an index specification
+	/** The indices of level of detail i are described by index specification numIndexSpecs + i. They reference the
+		same vertex data set as the full resolution index specification. Levels of one index specification are stored
+		from most to least detailed. To choose a level, project error to the screen: for a perspective projection with
+		vertical field of view fov onto a viewport h pixels high, it covers error * h / (2 * distance * tan(fov / 2))
+		pixels at distance from the camera. */
+	struct Lod
+	{
+		uint32_t indexSpec; ///< Full resolution index specification, less than numIndexSpecs
+		uint32_t level; ///< 1 for the first simplified level
+		float error; ///< Estimated largest distance between simplified and full resolution surface, in mesh units
+		uint32_t reserved;
+	};
+	static_assert(sizeof(Lod) == 16, "Lod struct not aligned correctly");
+
 	static const uint32_t kMagic = 0x8e8e54f1;
-	static const uint32_t kVersion = 1;
+	static const uint32_t kVersion = 2;
 
 	uint32_t magic; ///< File identification magic value
 	uint32_t version; ///< Version of the file format this file was written for
-	uint32_t reserved;
+	uint32_t meshletSetsOffset; ///< Byte offset inside file to one MeshletSet per index specification including levels of detail, 0 if there are no meshlets
 	uint32_t numBuffers; ///< Number of buffers (vertex and index buffers combined)
 	uint32_t numVertexDataSets; ///< Number of vertex data sets @see VertexDataSet
 	uint32_t numIndexSpecs; ///< Number of index specifications @see IndexBufferInfo
@@ -79,6 +121,8 @@ struct MeshFile
 	uint32_t indexSpecsOffset; ///< Byte offset inside file to index specifications
 	float boundsMin[3]; ///< Axis aligned bounding box minimum @see AxisAlignedBox
 	float boundsMax[3]; ///< Axis aligned bounding box maximum @see AxisAlignedBox
+	uint32_t numLods; ///< Number of simplified index specifications, stored after the full resolution ones @see Lod
+	uint32_t lodsOffset; ///< Byte offset inside file to one Lod per simplified index specification
 
 	// Buffers of type MeshFile::Buffer start here.
 	// Use GetBuffer or GetBufferData to access these buffers.
@@ -102,6 +146,37 @@ struct MeshFile
 		return reinterpret_cast<const IndexBufferInfo*>(reinterpret_cast<const char*>(this) + indexSpecsOffset)[i];
 	}
 
+	const Lod& GetLod(unsigned int i) const
+	{
+		assert(i < numLods);
+		return reinterpret_cast<const Lod*>(reinterpret_cast<const char*>(this) + lodsOffset)[i];
+	}
+
+	/// Index specification of a simplified level
+	const IndexBufferInfo& GetLodIndexSpec(unsigned int lod) const
+	{
+		assert(lod < numLods);
+		return reinterpret_cast<const IndexBufferInfo*>(reinterpret_cast<const char*>(this) + indexSpecsOffset)[numIndexSpecs + lod];
+	}
+
+	bool HasMeshlets() const
+	{
+		return meshletSetsOffset != 0;
+	}
+
+	const MeshletSet& GetMeshletSet(unsigned int indexSpec) const
+	{
+		assert(HasMeshlets() && indexSpec < numIndexSpecs + numLods);
+		return reinterpret_cast<const MeshletSet*>(reinterpret_cast<const char*>(this) + meshletSetsOffset)[indexSpec];
+	}
+
+	const Meshlet& GetMeshlet(unsigned int indexSpec, unsigned int i) const
+	{
+		const MeshletSet& set = GetMeshletSet(indexSpec);
+		assert(i < set.numMeshlets);
+		return reinterpret_cast<const Meshlet*>(reinterpret_cast<const char*>(this) + set.meshletsOffset)[i];
+	}
+
 	const void* GetBufferData(unsigned int i) const
 	{
 		return reinterpret_cast<const char*>(this) + GetBuffer(i).offset;
@@ -114,7 +189,7 @@ struct MeshFile
 	}
 };
 
-static_assert(sizeof(MeshFile) == 56, "Unexpected size for MeshFile");
+static_assert(sizeof(MeshFile) == 64, "Unexpected size for MeshFile");
 
 /** For unit test and mesh info tool. */
 inline std::ostream& operator<<(std::ostream& o, MeshFile::Buffer::Type type)
@@ -0,0 +1,355 @@
+/*	MeshFileView.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_MESHFILEVIEW_H
+#define MOLECULAR_MESHFILEVIEW_H
+
+#include "MeshFile.h"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace molecular
+{
+namespace meshfile
+{
+
+/// Read-only range of elements inside a mesh file
+template<typename T>
+class ConstSpan
+{
+public:
+	ConstSpan() = default;
+	ConstSpan(const T* data, size_t size) : mData(data), mSize(size) {}
+
+	const T* begin() const {return mData;}
+	const T* end() const {return mData + mSize;}
+	const T* data() const {return mData;}
+	size_t size() const {return mSize;}
+	bool empty() const {return mSize == 0;}
+
+	const T& operator[](size_t i) const
+	{
+		assert(i < mSize);
+		return mData[i];
+	}
+
+private:
+	const T* mData = nullptr;
+	size_t mSize = 0;
+};
+
+/// Validated zero-copy access to mesh file contents
+/** The constructor checks magic, version and every offset, size and count in the file against its length. Vertex and
+	index data itself is not touched, so this takes time proportional to the header only. Afterwards all accessors
+	return ranges that lie inside the file.
+	@see MapMeshFile */
+class MeshFileView
+{
+public:
+	/// Validate mesh file contents
+	/** @param data Start of the file contents, aligned to at least 4 bytes.
+		@param size Length of the file contents in bytes.
+		@throws std::runtime_error if the contents are not a valid mesh file. */
+	MeshFileView(const void* data, size_t size);
+
+	const MeshFile& GetFile() const {return *mFile;}
+	size_t GetSize() const {return mSize;}
+
+	ConstSpan<MeshFile::Buffer> GetBuffers() const
+	{
+		return At<MeshFile::Buffer>(sizeof(MeshFile), mFile->numBuffers);
+	}
+
+	ConstSpan<MeshFile::VertexDataSet> GetVertexDataSets() const
+	{
+		return At<MeshFile::VertexDataSet>(mFile->vertexDataSetsOffset, mFile->numVertexDataSets);
+	}
+
+	ConstSpan<VertexAttributeInfo> GetVertexSpecs(unsigned int dataSet) const
+	{
+		const MeshFile::VertexDataSet& set = GetVertexDataSets()[dataSet];
+		return At<VertexAttributeInfo>(set.vertexSpecsOffset, set.numVertexSpecs);
+	}
+
+	/// Full resolution index specifications
+	ConstSpan<IndexBufferInfo> GetIndexSpecs() const
+	{
+		return At<IndexBufferInfo>(mFile->indexSpecsOffset, mFile->numIndexSpecs);
+	}
+
+	ConstSpan<MeshFile::Lod> GetLods() const
+	{
+		return At<MeshFile::Lod>(mFile->lodsOffset, mFile->numLods);
+	}
+
+	/// Index specifications of the simplified levels, one per entry of GetLods()
+	ConstSpan<IndexBufferInfo> GetLodIndexSpecs() const
+	{
+		return At<IndexBufferInfo>(mFile->indexSpecsOffset + uint64_t(mFile->numIndexSpecs) * sizeof(IndexBufferInfo), mFile->numLods);
+	}
+
+	/// One meshlet set per index specification including levels of detail, empty if the file has no meshlets
+	ConstSpan<MeshFile::MeshletSet> GetMeshletSets() const
+	{
+		if(!mFile->HasMeshlets())
+			return ConstSpan<MeshFile::MeshletSet>();
+		return At<MeshFile::MeshletSet>(mFile->meshletSetsOffset, uint64_t(mFile->numIndexSpecs) + mFile->numLods);
+	}
+
+	/// Meshlets of an index specification, empty if the file has no meshlets
+	/** @param indexSpec Index of a full resolution index specification, or numIndexSpecs plus the index of a level of
+		detail. */
+	ConstSpan<MeshFile::Meshlet> GetMeshlets(unsigned int indexSpec) const
+	{
+		if(!mFile->HasMeshlets())
+			return ConstSpan<MeshFile::Meshlet>();
+		const MeshFile::MeshletSet& set = GetMeshletSets()[indexSpec];
+		return At<MeshFile::Meshlet>(set.meshletsOffset, set.numMeshlets);
+	}
+
+	ConstSpan<uint8_t> GetBufferData(unsigned int buffer) const
+	{
+		const MeshFile::Buffer& entry = GetBuffers()[buffer];
+		return At<uint8_t>(entry.offset, entry.size);
+	}
+
+	/// Size of one index of the given type in bytes, 0 if the type is unknown
+	static size_t GetIndexSize(IndexBufferInfo::Type type)
+	{
+		switch(type)
+		{
+		case IndexBufferInfo::Type::kUInt8: return 1;
+		case IndexBufferInfo::Type::kUInt16: return 2;
+		case IndexBufferInfo::Type::kUInt32: return 4;
+		}
+		return 0;
+	}
+
+	/// Size of one vertex attribute component of the given type in bytes, 0 if the type is unknown
+	static size_t GetComponentSize(VertexAttributeInfo::Type type)
+	{
+		switch(type)
+		{
+		case VertexAttributeInfo::kInt8:
+		case VertexAttributeInfo::kUInt8:
+			return 1;
+		case VertexAttributeInfo::kHalf:
+		case VertexAttributeInfo::kInt16:
+		case VertexAttributeInfo::kUInt16:
+			return 2;
+		case VertexAttributeInfo::kFloat:
+		case VertexAttributeInfo::kInt32:
+		case VertexAttributeInfo::kUInt32:
+			return 4;
+		}
+		return 0;
+	}
+
+private:
+	template<typename T>
+	ConstSpan<T> At(uint64_t offset, uint64_t count) const
+	{
+		return ConstSpan<T>(reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(mFile) + offset), count);
+	}
+
+	/// Check that count elements of type T at offset lie inside the file
+	template<typename T>
+	ConstSpan<T> CheckedAt(uint64_t offset, uint64_t count, const char* what) const
+	{
+		if(offset % alignof(T) != 0)
+			throw std::runtime_error(std::string(what) + " not aligned");
+		if(offset > mSize || count > (mSize - offset) / sizeof(T))
+			throw std::runtime_error(std::string(what) + " exceed file size");
+		return At<T>(offset, count);
+	}
+
+	const MeshFile* mFile;
+	size_t mSize;
+};
+
+inline MeshFileView::MeshFileView(const void* data, size_t size) :
+	mFile(static_cast<const MeshFile*>(data)),
+	mSize(size)
+{
+	if(reinterpret_cast<uintptr_t>(data) % alignof(MeshFile) != 0)
+		throw std::runtime_error("Mesh file data not aligned");
+	if(size < sizeof(MeshFile))
+		throw std::runtime_error("Mesh file too small");
+	if(mFile->magic != MeshFile::kMagic)
+		throw std::runtime_error("Unrecognized mesh file type");
+	if(mFile->version != MeshFile::kVersion)
+		throw std::runtime_error("Unsupported mesh file version " + std::to_string(mFile->version));
+
+	const auto buffers = CheckedAt<MeshFile::Buffer>(sizeof(MeshFile), mFile->numBuffers, "Buffer table");
+	for(auto& buffer: buffers)
+	{
+		if(buffer.type != MeshFile::Buffer::Type::kVertex && buffer.type != MeshFile::Buffer::Type::kIndex)
+			throw std::runtime_error("Invalid buffer type");
+		CheckedAt<uint8_t>(buffer.offset, buffer.size, "Buffer data");
+	}
+
+	const auto dataSets = CheckedAt<MeshFile::VertexDataSet>(mFile->vertexDataSetsOffset, mFile->numVertexDataSets, "Vertex data sets");
+	for(auto& dataSet: dataSets)
+	{
+		const auto specs = CheckedAt<VertexAttributeInfo>(dataSet.vertexSpecsOffset, dataSet.numVertexSpecs, "Vertex specifications");
+		for(auto& spec: specs)
+		{
+			if(spec.buffer >= buffers.size() || buffers[spec.buffer].type != MeshFile::Buffer::Type::kVertex)
+				throw std::runtime_error("Vertex specification refers to invalid buffer");
+			const uint64_t componentSize = GetComponentSize(spec.type);
+			if(componentSize == 0)
+				throw std::runtime_error("Invalid vertex attribute type");
+			if(dataSet.numVertices == 0)
+				continue;
+
+			// Last element of the attribute must end inside the buffer
+			const uint64_t elementSize = componentSize * spec.components;
+			const uint64_t stride = spec.stride ? spec.stride : elementSize;
+			const uint64_t bufferSize = buffers[spec.buffer].size;
+			const uint64_t lastOffset = uint64_t(dataSet.numVertices - 1) * stride;
+			if(lastOffset > bufferSize || spec.offset + lastOffset + elementSize > bufferSize)
+				throw std::runtime_error("Vertex attribute exceeds buffer size");
+		}
+	}
+
+	// Full resolution index specifications are followed by those of the levels of detail:
+	const uint64_t numIndexSpecs = uint64_t(mFile->numIndexSpecs) + mFile->numLods;
+	const auto indexSpecs = CheckedAt<IndexBufferInfo>(mFile->indexSpecsOffset, numIndexSpecs, "Index specifications");
+	for(auto& spec: indexSpecs)
+	{
+		if(spec.buffer >= buffers.size() || buffers[spec.buffer].type != MeshFile::Buffer::Type::kIndex)
+			throw std::runtime_error("Index specification refers to invalid buffer");
+		if(spec.vertexDataSet >= dataSets.size())
+			throw std::runtime_error("Index specification refers to invalid vertex data set");
+		const uint64_t indexSize = GetIndexSize(spec.type);
+		if(indexSize == 0)
+			throw std::runtime_error("Invalid index type");
+		if(spec.offset % indexSize != 0 || uint64_t(spec.offset) + spec.count * indexSize > buffers[spec.buffer].size)
+			throw std::runtime_error("Indices exceed buffer size");
+	}
+
+	const auto lods = CheckedAt<MeshFile::Lod>(mFile->lodsOffset, mFile->numLods, "Levels of detail");
+	for(size_t i = 0; i < lods.size(); ++i)
+	{
+		if(lods[i].indexSpec >= mFile->numIndexSpecs)
+			throw std::runtime_error("Level of detail refers to invalid index specification");
+		if(indexSpecs[mFile->numIndexSpecs + i].vertexDataSet != indexSpecs[lods[i].indexSpec].vertexDataSet)
+			throw std::runtime_error("Level of detail refers to different vertex data set");
+	}
+
+	if(mFile->HasMeshlets())
+	{
+		const auto meshletSets = CheckedAt<MeshFile::MeshletSet>(mFile->meshletSetsOffset, numIndexSpecs, "Meshlet sets");
+		for(size_t i = 0; i < meshletSets.size(); ++i)
+		{
+			const auto meshlets = CheckedAt<MeshFile::Meshlet>(meshletSets[i].meshletsOffset, meshletSets[i].numMeshlets, "Meshlets");
+			for(auto& meshlet: meshlets)
+			{
+				if(uint64_t(meshlet.indexOffset) + meshlet.indexCount > indexSpecs[i].count)
+					throw std::runtime_error("Meshlet exceeds index specification");
+			}
+		}
+	}
+}
+
+/// Read-only memory mapping of a validated mesh file
+/** Pages are loaded on first access, nothing is copied to the heap.
+	@see MapMeshFile */
+class MappedMeshFile
+{
+public:
+	/// Map and validate a file
+	/** @throws std::runtime_error if the file cannot be mapped or is not a valid mesh file. */
+	explicit MappedMeshFile(const std::string& fileName) :
+		mMapping(fileName),
+		mView(mMapping.data, mMapping.size)
+	{}
+
+	MappedMeshFile(MappedMeshFile&&) = default;
+
+	const MeshFileView& GetView() const {return mView;}
+	const MeshFileView* operator->() const {return &mView;}
+
+private:
+	struct Mapping
+	{
+		explicit Mapping(const std::string& fileName)
+		{
+			int fd = open(fileName.c_str(), O_RDONLY);
+			if(fd < 0)
+				throw std::runtime_error("Cannot open " + fileName);
+			struct stat st;
+			if(fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(MeshFile)))
+			{
+				close(fd);
+				throw std::runtime_error(fileName + " is not a mesh file");
+			}
+			size = st.st_size;
+			data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if(data == MAP_FAILED)
+				throw std::runtime_error("Cannot map " + fileName);
+		}
+
+		Mapping(Mapping&& other) : data(other.data), size(other.size)
+		{
+			other.data = nullptr;
+			other.size = 0;
+		}
+
+		Mapping(const Mapping&) = delete;
+		Mapping& operator=(const Mapping&) = delete;
+
+		~Mapping()
+		{
+			if(data)
+				munmap(data, size);
+		}
+
+		void* data = nullptr;
+		size_t size = 0;
+	};
+
+	Mapping mMapping;
+	MeshFileView mView;
+};
+
+/// Map a mesh file read-only and validate it
+/** @throws std::runtime_error if the file cannot be mapped or is not a valid mesh file. */
+inline MappedMeshFile MapMeshFile(const std::string& fileName)
+{
+	return MappedMeshFile(fileName);
+}
+
+}
+}
+
+#endif // MOLECULAR_MESHFILEVIEW_H